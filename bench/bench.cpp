@@ -0,0 +1,301 @@
+#include <Graphy/Graphy.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+// Renders synthetic scenes offscreen for a fixed number of
+// frames and prints two JSON objects per scene to stdout:
+// one with caches cleared every frame and one with them kept.
+//
+// Usage: graphy-bench [--frames N] [--size WxH]
+//                     [--max-points N] [--scene FILTER]
+////////////////////////////////////////////////////////////
+
+namespace
+{
+	typedef std::vector<std::unique_ptr<graphy::Graphable>> Graphables;
+
+	struct Scene
+	{
+		std::string name;
+		std::function<void(Graphables&)> build;
+	};
+
+	struct Options
+	{
+		Options() : frames(20), width(1280), height(720), max_points(1000000) {}
+		unsigned int frames;
+		unsigned int width, height;
+		std::size_t max_points;
+		std::string filter;
+	};
+
+	void equations(Graphables& g, unsigned int n)
+	{
+		for (unsigned int i = 0; i < n; ++i) {
+			double k = 1 + i;
+			g.emplace_back(new graphy::Equation([k](double x) { return std::sin(k * x) / k; }));
+		}
+	}
+
+	void shaded_equations(Graphables& g, unsigned int n)
+	{
+		//Each equation is shaded down to the previous one, like a confidence band
+		for (unsigned int i = 0; i < n; ++i) {
+			double k = 1 + i;
+			std::unique_ptr<graphy::Equation> eq(new graphy::Equation([k](double x) { return std::sin(k * x) / k; }));
+			eq->style.inequality.enabled = true;
+			eq->style.label.enabled = false;
+			if (!g.empty())
+				eq->fill_to = static_cast<graphy::Equation*>(g.back().get());
+			g.push_back(std::move(eq));
+		}
+	}
+
+	void data_set(Graphables& g, std::size_t n, bool join)
+	{
+		std::mt19937 en(42);
+		std::normal_distribution<double> noise(0, 0.1);
+		std::unique_ptr<graphy::DataSet> ds(new graphy::DataSet());
+		ds->points.reserve(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			double x = -1 + 2.0 * i / n;
+			ds->points.push_back(graphy::Point(x, x * x + noise(en)));
+			ds->points.back().style.shape = graphy::PointStyle::dot(2);
+		}
+		ds->join = join;
+		ds->style.label.enabled = false;
+		g.push_back(std::move(ds));
+	}
+
+	void implicit_equation(Graphables& g, float grain_size)
+	{
+		std::unique_ptr<graphy::ImplicitEquation> eq(new graphy::ImplicitEquation(
+			[](double x, double y) { return x*x + y*y - 0.5 + 0.1 * std::sin(10 * x); }));
+		eq->grain_size = grain_size;
+		eq->style.label.enabled = false;
+		g.push_back(std::move(eq));
+	}
+
+	void traced_equation(Graphables& g)
+	{
+		std::unique_ptr<graphy::ImplicitEquation> eq(new graphy::ImplicitEquation(
+			[](double x, double y) { return x*x + y*y - 0.5 + 0.1 * std::sin(10 * x); }));
+		eq->trace = true;
+		eq->style.label.enabled = false;
+		g.push_back(std::move(eq));
+	}
+
+	struct Wavy
+	{
+		template <typename T>
+		T operator()(const T& x, const T& y) const
+		{
+			using std::pow; using std::sin;
+			return pow(x, 2) + pow(y, 2) - 0.5 + 0.1 * sin(10 * x);
+		}
+	};
+
+	void interval_equation(Graphables& g, float grain_size)
+	{
+		std::unique_ptr<graphy::ImplicitEquation> eq(new graphy::IntervalImplicitEquation<Wavy>(Wavy()));
+		eq->grain_size = grain_size;
+		eq->style.label.enabled = false;
+		g.push_back(std::move(eq));
+	}
+
+	void color_map(Graphables& g, float grain_size, bool smooth)
+	{
+		std::unique_ptr<graphy::ColorMap> cm(new graphy::ColorMap([](double x, double y) {
+			return sf::Color(
+				static_cast<sf::Uint8>(127 + 127 * std::sin(5 * x)),
+				static_cast<sf::Uint8>(127 + 127 * std::cos(5 * y)),
+				127);
+		}));
+		cm->grain_size = grain_size;
+		cm->smooth = smooth;
+		g.push_back(std::move(cm));
+	}
+
+	void expression(Graphables& g, float grain_size)
+	{
+		std::unique_ptr<graphy::ImplicitEquation> eq(new graphy::ImplicitEquation(
+			graphy::Expression("x^2 + y^2 - 0.5 + 0.1 * sin(10 * x)")));
+		eq->grain_size = grain_size;
+		eq->style.label.enabled = false;
+		g.push_back(std::move(eq));
+	}
+
+	void parametric_curve(Graphables& g)
+	{
+		std::unique_ptr<graphy::ParametricCurve> c(new graphy::ParametricCurve(
+			[](double t) { return std::sin(3 * t); },
+			[](double t) { return std::sin(4 * t) * 0.9; }));
+		c->style.label.enabled = false;
+		g.push_back(std::move(c));
+	}
+
+	void polar_curve(Graphables& g)
+	{
+		std::unique_ptr<graphy::PolarCurve> c(new graphy::PolarCurve([](double theta) { return std::cos(7 * theta); }));
+		c->style.label.enabled = false;
+		g.push_back(std::move(c));
+	}
+
+	void histogram(Graphables& g, unsigned int n)
+	{
+		std::unique_ptr<graphy::Histogram> h(new graphy::Histogram());
+		h->normalise = false;
+		for (unsigned int i = 0; i < n; ++i) {
+			graphy::Bin bin(-1 + 2.0 * i / n, 2.0 / n, 0.5 + 0.4 * std::sin(0.01 * i));
+			bin.style.label.enabled = false;
+			h->bins.push_back(bin);
+		}
+		g.push_back(std::move(h));
+	}
+
+	std::vector<Scene> scenes(const Options& options)
+	{
+		std::vector<Scene> s;
+		for (unsigned int n : { 1u, 10u, 50u }) {
+			s.push_back({ "equation/" + std::to_string(n), [n](Graphables& g) { equations(g, n); } });
+			s.push_back({ "equation-fill/" + std::to_string(n), [n](Graphables& g) { shaded_equations(g, n); } });
+		}
+		for (std::size_t n = 1000; n <= 10000000 && n <= options.max_points; n *= 10) {
+			s.push_back({ "dataset/" + std::to_string(n), [n](Graphables& g) { data_set(g, n, false); } });
+			s.push_back({ "dataset-join/" + std::to_string(n), [n](Graphables& g) { data_set(g, n, true); } });
+		}
+		for (float grain : { 1.f, 3.f, 5.f, 10.f }) {
+			std::string suffix = std::to_string(static_cast<int>(grain));
+			s.push_back({ "implicit/grain" + suffix, [grain](Graphables& g) { implicit_equation(g, grain); } });
+			s.push_back({ "implicit-interval/grain" + suffix, [grain](Graphables& g) { interval_equation(g, grain); } });
+			s.push_back({ "colormap/grain" + suffix, [grain](Graphables& g) { color_map(g, grain, false); } });
+			s.push_back({ "colormap-smooth/grain" + suffix, [grain](Graphables& g) { color_map(g, grain, true); } });
+			s.push_back({ "expression/grain" + suffix, [grain](Graphables& g) { expression(g, grain); } });
+		}
+		s.push_back({ "implicit-trace", [](Graphables& g) { traced_equation(g); } });
+		s.push_back({ "parametric", [](Graphables& g) { parametric_curve(g); } });
+		s.push_back({ "polar", [](Graphables& g) { polar_curve(g); } });
+		for (unsigned int n : { 10u, 1000u, 100000u }) {
+			s.push_back({ "histogram/" + std::to_string(n), [n](Graphables& g) { histogram(g, n); } });
+		}
+		return s;
+	}
+
+	void run(const Scene& scene, const Options& options, bool cold)
+	{
+		graphy::Graph graph(options.width, options.height);
+		graph.zoom_to(-1.5, 1.5, -1, 1);
+		Graphables g;
+		scene.build(g);
+		for (auto& graphable : g)
+			graph.add(*graphable);
+
+		std::vector<double> frame_ms;
+		double clear = 0, prepare = 0, draw = 0, composite = 0;
+		std::size_t vertices = 0;
+		unsigned int draw_calls = 0;
+		//Render one warm up frame, then force every graphable to be redrawn each
+		//frame. Cold frames invalidate the graph, which also clears anything the
+		//graphables have cached. Warm frames keep the caches and instead pan by
+		//about a pixel back and forth, which redraws every layer. The offset is a
+		//power of two so that the width of the view, and with it the grid that
+		//samples are cached on, stays exactly the same.
+		graph.set_damage_tracking(true);
+		graph.update();
+		for (unsigned int i = 0; i < options.frames; ++i) {
+			if (cold)
+				graph.invalidate();
+			else {
+				double offset = i % 2 == 0 ? 1.0 / 1024 : 0;
+				graph.zoom_to(-1.5 + offset, 1.5 + offset, -1, 1);
+			}
+			graph.update();
+			const graphy::Graph::FrameStats& stats = graph.stats();
+			frame_ms.push_back(stats.frame_time * 1000.0);
+			clear += stats.clear_time * 1000.0;
+			prepare += stats.prepare_time * 1000.0;
+			draw += stats.draw_time * 1000.0;
+			composite += stats.composite_time * 1000.0;
+			vertices = 0;
+			draw_calls = 0;
+			for (const graphy::Graph::GraphableStats& gs : stats.graphables) {
+				vertices += gs.vertices;
+				draw_calls += gs.draw_calls;
+			}
+		}
+
+		std::vector<double> sorted = frame_ms;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0;
+		for (double ms : frame_ms)
+			total += ms;
+		double n = static_cast<double>(frame_ms.size());
+
+		std::cout << "{\"scene\": \"" << scene.name << "\""
+			<< ", \"cache\": \"" << (cold ? "cold" : "warm") << "\""
+			<< ", \"frames\": " << frame_ms.size()
+			<< ", \"mean_ms\": " << total / n
+			<< ", \"median_ms\": " << sorted[sorted.size() / 2]
+			<< ", \"min_ms\": " << sorted.front()
+			<< ", \"max_ms\": " << sorted.back()
+			<< ", \"clear_ms\": " << clear / n
+			<< ", \"prepare_ms\": " << prepare / n
+			<< ", \"draw_ms\": " << draw / n
+			<< ", \"composite_ms\": " << composite / n
+			<< ", \"draw_calls\": " << draw_calls
+			<< ", \"vertices\": " << vertices
+			<< "}" << std::endl;
+	}
+
+	bool parse(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (i + 1 >= argc)
+				return false;
+			std::string value = argv[++i];
+			if (arg == "--frames")
+				options.frames = std::max(1, std::atoi(value.c_str()));
+			else if (arg == "--max-points")
+				options.max_points = std::strtoull(value.c_str(), nullptr, 10);
+			else if (arg == "--scene")
+				options.filter = value;
+			else if (arg == "--size") {
+				char x;
+				std::stringstream s(value);
+				if (!(s >> options.width >> x >> options.height) || x != 'x')
+					return false;
+			}
+			else
+				return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parse(argc, argv, options)) {
+		std::cerr << "Usage: " << argv[0] << " [--frames N] [--size WxH] [--max-points N] [--scene FILTER]\n";
+		return 1;
+	}
+
+	for (const Scene& scene : scenes(options)) {
+		if (scene.name.find(options.filter) != std::string::npos) {
+			run(scene, options, true);
+			run(scene, options, false);
+		}
+	}
+	return 0;
+}
@@ -5,7 +5,7 @@ int main()
   using namespace graphy;
   Graph g;
   Axes ax;
-  Equation eq([] (double x) {return x*x;});
+  auto eq = make_equation([] (double x) {return x*x;});
   g.add(ax.x);
   g.add(ax.y);
   g.add(eq);
@@ -0,0 +1,406 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_DUAL_H
+#define GRAPHY_DUAL_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cmath>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Dual number for forward-mode automatic differentiation
+	///
+	/// A dual number carries a value together with its derivative,
+	/// and arithmetic and the functions of <cmath> on dual numbers
+	/// apply the chain rule as they go. Evaluating a function on
+	/// Dual<double>(x, 1) gives its value and exact derivative at x.
+	/// Dual numbers may be nested to find higher derivatives.
+	///
+	/// Functions which are templated on their argument type can be
+	/// differentiated this way:
+	///
+	/// \code
+	/// struct Gaussian
+	/// {
+	///     template <typename T>
+	///     T operator()(const T& x) const { return exp(-x*x / 2); }
+	/// };
+	/// graphy::Dual<double> d = Gaussian()(graphy::Dual<double>(1, 1)); //d.derivative == -exp(-0.5)
+	/// \endcode
+	///
+	/// The functions must be called unqualified (exp rather than 
+	/// std::exp) so that the overloads for dual numbers are found.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename T>
+	struct Dual
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Default constructor
+		///
+		/// Constructs the constant 0.
+		///
+		////////////////////////////////////////////////////////////
+		Dual() :
+			value(), derivative()
+		{
+
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs a constant, whose derivatives are all 0.
+		///
+		/// \param value Value of the number
+		///
+		////////////////////////////////////////////////////////////
+		Dual(double value) :
+			value(value), derivative()
+		{
+
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param value Value of the number
+		/// \param derivative Derivative of the value
+		///
+		////////////////////////////////////////////////////////////
+		Dual(const T& value, const T& derivative) :
+			value(value), derivative(derivative)
+		{
+
+		}
+
+		Dual& operator += (const Dual& rhs) { return *this = *this + rhs; }
+		Dual& operator -= (const Dual& rhs) { return *this = *this - rhs; }
+		Dual& operator *= (const Dual& rhs) { return *this = *this * rhs; }
+		Dual& operator /= (const Dual& rhs) { return *this = *this / rhs; }
+		Dual& operator += (double rhs) { return *this = *this + rhs; }
+		Dual& operator -= (double rhs) { return *this = *this - rhs; }
+		Dual& operator *= (double rhs) { return *this = *this * rhs; }
+		Dual& operator /= (double rhs) { return *this = *this / rhs; }
+
+		T value; ///< Value of the number
+		T derivative; ///< Derivative of the value
+	};
+
+	////////////////////////////////////////////////////////////
+	// Arithmetic
+	////////////////////////////////////////////////////////////
+	template <typename T> Dual<T> operator + (const Dual<T>& a) { return a; }
+	template <typename T> Dual<T> operator - (const Dual<T>& a) { return Dual<T>(-a.value, -a.derivative); }
+
+	template <typename T> Dual<T> operator + (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value + b.value, a.derivative + b.derivative); }
+	template <typename T> Dual<T> operator + (const Dual<T>& a, double b) { return Dual<T>(a.value + b, a.derivative); }
+	template <typename T> Dual<T> operator + (double a, const Dual<T>& b) { return Dual<T>(a + b.value, b.derivative); }
+
+	template <typename T> Dual<T> operator - (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value - b.value, a.derivative - b.derivative); }
+	template <typename T> Dual<T> operator - (const Dual<T>& a, double b) { return Dual<T>(a.value - b, a.derivative); }
+	template <typename T> Dual<T> operator - (double a, const Dual<T>& b) { return Dual<T>(a - b.value, -b.derivative); }
+
+	template <typename T> Dual<T> operator * (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value * b.value, a.derivative * b.value + a.value * b.derivative); }
+	template <typename T> Dual<T> operator * (const Dual<T>& a, double b) { return Dual<T>(a.value * b, a.derivative * b); }
+	template <typename T> Dual<T> operator * (double a, const Dual<T>& b) { return Dual<T>(a * b.value, a * b.derivative); }
+
+	template <typename T> Dual<T> operator / (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value / b.value, (a.derivative * b.value - a.value * b.derivative) / (b.value * b.value)); }
+	template <typename T> Dual<T> operator / (const Dual<T>& a, double b) { return Dual<T>(a.value / b, a.derivative / b); }
+	template <typename T> Dual<T> operator / (double a, const Dual<T>& b) { return Dual<T>(a / b.value, -a * b.derivative / (b.value * b.value)); }
+
+	////////////////////////////////////////////////////////////
+	// Comparisons, which only compare values so that branches 
+	// in a function take the same path as for doubles
+	////////////////////////////////////////////////////////////
+	template <typename T> bool operator < (const Dual<T>& a, const Dual<T>& b) { return a.value < b.value; }
+	template <typename T> bool operator < (const Dual<T>& a, double b) { return a.value < b; }
+	template <typename T> bool operator < (double a, const Dual<T>& b) { return a < b.value; }
+	template <typename T> bool operator > (const Dual<T>& a, const Dual<T>& b) { return a.value > b.value; }
+	template <typename T> bool operator > (const Dual<T>& a, double b) { return a.value > b; }
+	template <typename T> bool operator > (double a, const Dual<T>& b) { return a > b.value; }
+	template <typename T> bool operator <= (const Dual<T>& a, const Dual<T>& b) { return a.value <= b.value; }
+	template <typename T> bool operator <= (const Dual<T>& a, double b) { return a.value <= b; }
+	template <typename T> bool operator <= (double a, const Dual<T>& b) { return a <= b.value; }
+	template <typename T> bool operator >= (const Dual<T>& a, const Dual<T>& b) { return a.value >= b.value; }
+	template <typename T> bool operator >= (const Dual<T>& a, double b) { return a.value >= b; }
+	template <typename T> bool operator >= (double a, const Dual<T>& b) { return a >= b.value; }
+	template <typename T> bool operator == (const Dual<T>& a, const Dual<T>& b) { return a.value == b.value; }
+	template <typename T> bool operator == (const Dual<T>& a, double b) { return a.value == b; }
+	template <typename T> bool operator == (double a, const Dual<T>& b) { return a == b.value; }
+	template <typename T> bool operator != (const Dual<T>& a, const Dual<T>& b) { return a.value != b.value; }
+	template <typename T> bool operator != (const Dual<T>& a, double b) { return a.value != b; }
+	template <typename T> bool operator != (double a, const Dual<T>& b) { return a != b.value; }
+
+	////////////////////////////////////////////////////////////
+	// Functions
+	////////////////////////////////////////////////////////////
+	template <typename T> Dual<T> sqrt(const Dual<T>& a)
+	{
+		using std::sqrt;
+		T s = sqrt(a.value);
+		return Dual<T>(s, a.derivative / (2 * s));
+	}
+
+	template <typename T> Dual<T> abs(const Dual<T>& a)
+	{
+		return a.value < 0 ? -a : a;
+	}
+
+	template <typename T> Dual<T> fabs(const Dual<T>& a)
+	{
+		return a.value < 0 ? -a : a;
+	}
+
+	template <typename T> Dual<T> floor(const Dual<T>& a)
+	{
+		using std::floor;
+		return Dual<T>(floor(a.value), T());
+	}
+
+	template <typename T> Dual<T> ceil(const Dual<T>& a)
+	{
+		using std::ceil;
+		return Dual<T>(ceil(a.value), T());
+	}
+
+	template <typename T> Dual<T> trunc(const Dual<T>& a)
+	{
+		using std::trunc;
+		return Dual<T>(trunc(a.value), T());
+	}
+
+	template <typename T> Dual<T> sin(const Dual<T>& a)
+	{
+		using std::sin; using std::cos;
+		return Dual<T>(sin(a.value), a.derivative * cos(a.value));
+	}
+
+	template <typename T> Dual<T> cos(const Dual<T>& a)
+	{
+		using std::sin; using std::cos;
+		return Dual<T>(cos(a.value), -a.derivative * sin(a.value));
+	}
+
+	template <typename T> Dual<T> tan(const Dual<T>& a)
+	{
+		using std::tan;
+		T t = tan(a.value);
+		return Dual<T>(t, a.derivative * (1 + t * t));
+	}
+
+	template <typename T> Dual<T> asin(const Dual<T>& a)
+	{
+		using std::asin; using std::sqrt;
+		return Dual<T>(asin(a.value), a.derivative / sqrt(1 - a.value * a.value));
+	}
+
+	template <typename T> Dual<T> acos(const Dual<T>& a)
+	{
+		using std::acos; using std::sqrt;
+		return Dual<T>(acos(a.value), -a.derivative / sqrt(1 - a.value * a.value));
+	}
+
+	template <typename T> Dual<T> atan(const Dual<T>& a)
+	{
+		using std::atan;
+		return Dual<T>(atan(a.value), a.derivative / (1 + a.value * a.value));
+	}
+
+	template <typename T> Dual<T> sinh(const Dual<T>& a)
+	{
+		using std::sinh; using std::cosh;
+		return Dual<T>(sinh(a.value), a.derivative * cosh(a.value));
+	}
+
+	template <typename T> Dual<T> cosh(const Dual<T>& a)
+	{
+		using std::sinh; using std::cosh;
+		return Dual<T>(cosh(a.value), a.derivative * sinh(a.value));
+	}
+
+	template <typename T> Dual<T> tanh(const Dual<T>& a)
+	{
+		using std::tanh;
+		T t = tanh(a.value);
+		return Dual<T>(t, a.derivative * (1 - t * t));
+	}
+
+	template <typename T> Dual<T> exp(const Dual<T>& a)
+	{
+		using std::exp;
+		T e = exp(a.value);
+		return Dual<T>(e, a.derivative * e);
+	}
+
+	template <typename T> Dual<T> log(const Dual<T>& a)
+	{
+		using std::log;
+		return Dual<T>(log(a.value), a.derivative / a.value);
+	}
+
+	template <typename T> Dual<T> log10(const Dual<T>& a)
+	{
+		using std::log10;
+		return Dual<T>(log10(a.value), a.derivative / (a.value * 2.30258509299404568402));
+	}
+
+	template <typename T> Dual<T> pow(const Dual<T>& a, double b)
+	{
+		using std::pow;
+		if (b == 0)
+			return Dual<T>(1.0);
+		return Dual<T>(pow(a.value, b), a.derivative * b * pow(a.value, b - 1));
+	}
+
+	template <typename T> Dual<T> pow(double a, const Dual<T>& b)
+	{
+		using std::pow; using std::log;
+		T p = pow(a, b.value);
+		return Dual<T>(p, b.derivative * p * std::log(a));
+	}
+
+	template <typename T> Dual<T> pow(const Dual<T>& a, const Dual<T>& b)
+	{
+		using std::pow; using std::log;
+		T p = pow(a.value, b.value);
+		return Dual<T>(p, p * (b.derivative * log(a.value) + b.value * a.derivative / a.value));
+	}
+
+	template <typename T> Dual<T> atan2(const Dual<T>& y, const Dual<T>& x)
+	{
+		using std::atan2;
+		return Dual<T>(atan2(y.value, x.value), (x.value * y.derivative - y.value * x.derivative) / (x.value * x.value + y.value * y.value));
+	}
+
+	template <typename T> Dual<T> hypot(const Dual<T>& a, const Dual<T>& b)
+	{
+		using std::hypot;
+		T h = hypot(a.value, b.value);
+		return Dual<T>(h, (a.value * a.derivative + b.value * b.derivative) / h);
+	}
+
+	template <typename T> Dual<T> fmod(const Dual<T>& a, const Dual<T>& b)
+	{
+		using std::fmod; using std::trunc;
+		return Dual<T>(fmod(a.value, b.value), a.derivative - b.derivative * trunc(a.value / b.value));
+	}
+
+	template <typename T> Dual<T> min(const Dual<T>& a, const Dual<T>& b)
+	{
+		return b.value < a.value ? b : a;
+	}
+
+	template <typename T> Dual<T> max(const Dual<T>& a, const Dual<T>& b)
+	{
+		return a.value < b.value ? b : a;
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Highest order of derivative calculated by differentiate()
+	///
+	////////////////////////////////////////////////////////////
+	const unsigned int max_dual_order = 4;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Dual numbers nested N times, which carry the first N derivatives of a value
+	///
+	////////////////////////////////////////////////////////////
+	template <unsigned int N>
+	struct NestedDual
+	{
+		typedef Dual<typename NestedDual<N - 1>::Type> Type;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the variable x, whose first derivative is 1
+		///
+		////////////////////////////////////////////////////////////
+		static Type variable(double x)
+		{
+			return Type(NestedDual<N - 1>::variable(x), 1.0);
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Writes the value and first N derivatives carried by \a a to \a result
+		///
+		////////////////////////////////////////////////////////////
+		static void derivatives(const Type& a, double* result)
+		{
+			NestedDual<N - 1>::derivatives(a.value, result);
+			result[N] = NestedDual<N - 1>::highest(a.derivative);
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the N-th derivative carried by \a a
+		///
+		////////////////////////////////////////////////////////////
+		static double highest(const Type& a)
+		{
+			return NestedDual<N - 1>::highest(a.derivative);
+		}
+	};
+
+	template <>
+	struct NestedDual<0>
+	{
+		typedef double Type;
+		static Type variable(double x) { return x; }
+		static void derivatives(double a, double* result) { result[0] = a; }
+		static double highest(double a) { return a; }
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Calculates the value and first \a n derivatives of a function exactly
+	///
+	/// \a function is called once with the argument as dual
+	/// numbers nested \a n times, so it must accept NestedDual<n>::Type.
+	///
+	/// \param function Function of one variable templated on its argument type
+	/// \param x Value at which to differentiate the function
+	/// \param result Array of \a n + 1 values to receive the value and each derivative
+	/// \param n Number of derivatives to calculate
+	///
+	/// \return False, leaving \a result unchanged, if \a n is more than max_dual_order
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	bool differentiate(const F& function, double x, double* result, unsigned int n)
+	{
+		switch (n) {
+		case 0: NestedDual<0>::derivatives(function(NestedDual<0>::variable(x)), result); return true;
+		case 1: NestedDual<1>::derivatives(function(NestedDual<1>::variable(x)), result); return true;
+		case 2: NestedDual<2>::derivatives(function(NestedDual<2>::variable(x)), result); return true;
+		case 3: NestedDual<3>::derivatives(function(NestedDual<3>::variable(x)), result); return true;
+		case 4: NestedDual<4>::derivatives(function(NestedDual<4>::variable(x)), result); return true;
+		default: return false;
+		}
+	}
+
+} // namespace graphy
+
+#endif //GRAPHY_DUAL_H
@@ -0,0 +1,214 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_EXPRESSION_H
+#define GRAPHY_EXPRESSION_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <Graphy/Dual.hpp>
+#include <Graphy/Interval.hpp>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Mathematical expression compiled from a string
+	///
+	/// An expression is parsed once into a short program in which
+	/// constant subexpressions are folded, repeated subexpressions
+	/// are shared and small integer powers become multiplications.
+	/// The program is run over arrays of values a block at a time,
+	/// with each instruction a simple loop over the block, and any
+	/// part of the expression which only depends on single values
+	/// (such as the y-value of a row) is calculated once per call.
+	///
+	/// Expressions are made of numbers, the variables named when
+	/// the expression is constructed, the constants pi and e, the
+	/// operators + - * / ^ and parentheses, and the functions
+	/// sin, cos, tan, asin, acos, atan, sinh, cosh, tanh, exp, 
+	/// log (or ln), log10, sqrt, abs, floor, ceil, and the two 
+	/// argument functions atan2, pow, min, max, hypot and mod.
+	///
+	/// \code
+	/// graphy::ImplicitEquation eq(graphy::Expression("sin(x)*exp(-y^2) - 0.5"));
+	/// \endcode
+	///
+	/// Evaluating an expression is thread-safe.
+	///
+	////////////////////////////////////////////////////////////
+	class Expression
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Compiles \a text. If it is not a valid expression the
+		/// error is printed, valid() returns false and the 
+		/// expression evaluates to NaN.
+		///
+		/// \param text Text of the expression
+		/// \param variables Names of the variables, in the order their values are given when evaluating
+		///
+		////////////////////////////////////////////////////////////
+		Expression(const std::string& text, const std::vector<std::string>& variables = std::vector<std::string>{ "x", "y" });
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns false if the expression could not be compiled
+		///
+		////////////////////////////////////////////////////////////
+		bool valid() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns a description of why the expression could not be compiled
+		///
+		////////////////////////////////////////////////////////////
+		const std::string& error() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the text the expression was compiled from
+		///
+		////////////////////////////////////////////////////////////
+		const std::string& text() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression with the first variable equal to \a x and any others 0
+		///
+		////////////////////////////////////////////////////////////
+		double operator()(double x) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression with the first two variables equal to \a x and \a y and any others 0
+		///
+		////////////////////////////////////////////////////////////
+		double operator()(double x, double y) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression on a dual number, with any other variables 0
+		///
+		/// The derivatives of the result are exact. Dual numbers may
+		/// be nested up to max_dual_order times, so expressions can
+		/// be passed to differentiate().
+		///
+		////////////////////////////////////////////////////////////
+		template <typename T>
+		Dual<T> operator()(const Dual<T>& x) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Bounds the expression over intervals of the first two variables, with any others 0
+		///
+		/// \param x Interval of the first variable
+		/// \param y Interval of the second variable
+		///
+		/// \return Interval containing every value of the expression within \a x and \a y
+		///
+		////////////////////////////////////////////////////////////
+		Interval operator()(const Interval& x, const Interval& y) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Calculates the value and first \a n derivatives with respect to the first variable, with any others 0
+		///
+		/// \param x Value of the first variable
+		/// \param result Array of \a n + 1 values to receive the value and each derivative
+		/// \param n Number of derivatives to calculate
+		///
+		/// \return False if \a n is more than max_dual_order
+		///
+		////////////////////////////////////////////////////////////
+		bool derivatives(double x, double* result, unsigned int n) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression at an array of values of the first variable, with any others 0
+		///
+		/// \param x Array of \a count values of the first variable
+		/// \param result Array of \a count values to receive the value of the expression
+		/// \param count Number of values
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, double* result, std::size_t count) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression along a row of points with the same second variable
+		///
+		/// \param x Array of \a count values of the first variable
+		/// \param y Value of the second variable
+		/// \param result Array of \a count values to receive the value of the expression
+		/// \param count Number of values
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, double y, double* result, std::size_t count) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the expression at arrays of values of the first two variables
+		///
+		/// \param x Array of \a count values of the first variable
+		/// \param y Array of \a count values of the second variable
+		/// \param result Array of \a count values to receive the value of the expression
+		/// \param count Number of values
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, const double* y, double* result, std::size_t count) const;
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Single operation of the compiled program
+		///
+		////////////////////////////////////////////////////////////
+		struct Node
+		{
+			unsigned char op; ///< Operation, defined in Expression.cpp
+			int a, b; ///< Indices of the operands, or for variables the index of the variable in a
+			double value; ///< Value of constants
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Value of a variable, either an array or a single value
+		///
+		////////////////////////////////////////////////////////////
+		struct Input
+		{
+			const double* array; ///< Array of values, or nullptr to use \a value
+			double value; ///< Value if \a array is nullptr
+		};
+
+		class Parser;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Runs the program over \a count sets of inputs, one per variable
+		///
+		////////////////////////////////////////////////////////////
+		void run(const Input* inputs, double* result, std::size_t count) const;
+
+		std::string source; ///< Text of the expression
+		std::string message; ///< Error message if the text could not be compiled
+		std::vector<std::string> names; ///< Names of the variables
+		std::vector<Node> program; ///< Operations in evaluation order, with the result last
+	};
+
+} // namespace graphy
+
+#endif //GRAPHY_EXPRESSION_H
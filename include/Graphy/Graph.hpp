@@ -32,9 +32,14 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <string>
+#include <memory>
+#include <atomic>
 #include <Graphy/Utils/StatusBar.hpp>
+#include <Graphy/Utils/ThreadPool.hpp>
+#include <Graphy/Utils/VertexBatch.hpp>
 #include <Graphy/Utils/Vector2d.hpp>
 #include <Graphy/Utils/DoubleRect.hpp>
+#include <Graphy/Viewport.hpp>
 
 namespace graphy
 {
@@ -48,6 +53,37 @@ namespace graphy
 	class Graph
 	{
 	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Rendering statistics of a graphable for a single update
+		///
+		////////////////////////////////////////////////////////////
+		struct GraphableStats
+		{
+			const Graphable* graphable; ///< The graphable the statistics describe
+			bool drawn; ///< False if the graphable was unchanged and its previous render was reused
+			float prepare_time; ///< Time in seconds spent in the graphable's prepare function
+			float draw_time; ///< Time in seconds spent in the graphable's draw function
+			unsigned int draw_calls; ///< Number of draw calls the graphable made to its canvas
+			std::size_t vertices; ///< Number of vertices the graphable submitted to its canvas
+			std::size_t bytes_allocated; ///< Number of bytes by which the canvas's vertex buffers grew while drawing the graphable
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Rendering statistics of a single update
+		///
+		////////////////////////////////////////////////////////////
+		struct FrameStats
+		{
+			float clear_time; ///< Time in seconds spent finding and clearing damaged layers
+			float prepare_time; ///< Time in seconds spent preparing graphables in parallel
+			float draw_time; ///< Time in seconds spent drawing graphables
+			float composite_time; ///< Time in seconds spent submitting the layers and compositing them onto the window
+			float status_bar_time; ///< Time in seconds spent drawing the status bar
+			float frame_time; ///< Total time in seconds spent in the update
+			float framerate; ///< Number of updates per second, averaged over the last second
+			std::vector<GraphableStats> graphables; ///< Statistics of each graphable, in the order they were added
+		};
+
 		////////////////////////////////////////////////////////////
 		/// \brief Constructs a new graph
 		///
@@ -61,6 +97,21 @@ namespace graphy
 		///
 		////////////////////////////////////////////////////////////
 		Graph(const std::string& title = "Graphy", bool fullscreen = false, unsigned int width = 800, unsigned int height = 800);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructs a new headless graph
+		///
+		/// This constructor creates the graph without a window. 
+		/// Graphables are rendered offscreen into a canvas of the 
+		/// size defined by the parameters each time update() is 
+		/// called, and the result can be retrieved with capture() 
+		/// or saved with print().
+		///
+		/// \param width		Width of the canvas in pixels
+		/// \param height		Height of the canvas in pixels
+		///
+		////////////////////////////////////////////////////////////
+		Graph(unsigned int width, unsigned int height);
 		
 		////////////////////////////////////////////////////////////
 		/// \brief Destructor
@@ -161,6 +212,87 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		void clear();
 
+		////////////////////////////////////////////////////////////
+		/// \brief Forces every graphable to be redrawn on the next update
+		///
+		/// Every graphable is invalidated, which also discards any
+		/// values it has cached from previous frames.
+		///
+		////////////////////////////////////////////////////////////
+		void invalidate();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Enables or disables damage tracking
+		///
+		/// When damage tracking is enabled, update() only redraws 
+		/// the layers containing graphables which have been 
+		/// invalidated, and reuses the previous render of every 
+		/// other layer. Graphables also keep values they have 
+		/// evaluated between frames. When it is disabled (the 
+		/// default) every graphable is redrawn on every update, and
+		/// values graphables cache between frames are discarded 
+		/// before each update.
+		///
+		/// Before enabling it, make sure that Graphable::invalidate()
+		/// is called after every change to the public data of a 
+		/// graphable, such as the points of a DataSet or the style
+		/// or function of an Equation, as the graph cannot detect
+		/// these changes itself and would otherwise keep showing the
+		/// previous render.
+		///
+		/// \param enabled True to only redraw changed layers
+		///
+		////////////////////////////////////////////////////////////
+		void set_damage_tracking(bool enabled);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Enables or disables on-demand rendering in the mainloop
+		///
+		/// By default the mainloop redraws the graph continuously.
+		/// In on-demand mode it sleeps until there is something to
+		/// show: an input event, a resize, a call to request_update()
+		/// or invalidate(), or an animation (see set_animating()).
+		/// Keyboard navigation and dragging still redraw every frame
+		/// while a key or button is held.
+		///
+		/// \param enabled True to only redraw when something changes
+		///
+		////////////////////////////////////////////////////////////
+		void set_on_demand(bool enabled);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Keeps the mainloop redrawing in on-demand mode
+		///
+		/// Set this while graphables are changing every frame, for
+		/// example during an animation.
+		///
+		/// \param animating True to redraw continuously
+		///
+		////////////////////////////////////////////////////////////
+		void set_animating(bool animating);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Wakes the mainloop so that the graph is redrawn
+		///
+		/// Only needed in on-demand mode. This may be called from 
+		/// any thread, for example after new data has arrived.
+		///
+		////////////////////////////////////////////////////////////
+		void request_update();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sets the number of threads used to prepare graphables
+		///
+		/// Graphables build their geometry in parallel before they
+		/// are drawn, so the functions they evaluate must be safe to
+		/// call from several threads at once. Setting the number of
+		/// threads to 1 prepares every graphable on the calling thread.
+		///
+		/// \param count Number of threads, or 0 to use one per hardware thread (the default)
+		///
+		////////////////////////////////////////////////////////////
+		void set_threads(unsigned int count);
+
 		////////////////////////////////////////////////////////////
 		/// \brief Load a font from file and use it as the default font for labels
 		///
@@ -186,6 +318,8 @@ namespace graphy
 		///
 		/// In interactive mode, the graph is displayed in a blocking
 		/// window and can be traversed using the arrow keys etc...
+		/// A headless graph has no window, so it is updated once and
+		/// the function returns immediately.
 		///
 		////////////////////////////////////////////////////////////
 		void mainloop();
@@ -194,14 +328,50 @@ namespace graphy
 		/// \brief Updates the graph
 		///
 		/// Clears the canvas and then redraws all graphables currently
-		/// bound to the graph.
+		/// bound to the graph. Layers are only redrawn if the viewport
+		/// has changed or they contain an invalidated graphable (see
+		/// set_damage_tracking). If the graph is headless the canvas is
+		/// not composited onto a window.
 		///
 		////////////////////////////////////////////////////////////
 		void update();
 
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the rendering statistics of the last update
+		///
+		////////////////////////////////////////////////////////////
+		const FrameStats& stats() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Resizes the canvas of the graph
+		///
+		/// For a windowed graph the window is resized so that the
+		/// area above the status bar has the given size.
+		///
+		/// \param width		Width of the canvas in pixels
+		/// \param height		Height of the canvas in pixels
+		///
+		////////////////////////////////////////////////////////////
+		void resize(unsigned int width, unsigned int height);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns an image of the current graph viewport
+		///
+		/// The image contains the layers as they were drawn by the 
+		/// last call to update(), composited onto the background 
+		/// colour. Its pixels can be accessed as an RGBA buffer with
+		/// sf::Image::getPixelsPtr.
+		///
+		/// \return An image of the graph canvas
+		///
+		////////////////////////////////////////////////////////////
+		sf::Image capture();
+
 		////////////////////////////////////////////////////////////
 		/// \brief Takes a screenshot of the current graph viewport
 		///
+		/// \param filename Name of the image file to save, the format is deduced from the extension
+		///
 		////////////////////////////////////////////////////////////
 		void print(const std::string& filename);
 
@@ -211,6 +381,8 @@ namespace graphy
 		//Display
 		sf::RenderWindow window; ///< Render window that is shown in the mainloop
 		sf::RenderTexture layers[4]; ///< Render textures to hold different layers of the graph
+		xsf::VertexBatch batches[4]; ///< Primitives waiting to be drawn to each layer
+		bool headless; ///< True if the graph renders offscreen without a window
 		xsf::StatusBar sbar;
 		static sf::ContextSettings context;
 		static float status_bar_height;
@@ -221,11 +393,38 @@ namespace graphy
 		unsigned int height(bool), width(bool);
 		std::string default_filename;
 		int print_counter;
+		void create_layers(unsigned int width, unsigned int height);
 
 		//Graphing elements
 		std::vector<Graphable*> graphables;
 		sf::DoubleRect bounds;
 
+		//Damage tracking
+		static const unsigned char all_layers = 0xF;
+		bool damage_tracking; ///< If false every layer is redrawn on every update
+		unsigned char damaged_layers; ///< Bitmask of the layers to be redrawn on the next update
+		unsigned char redraw_mask; ///< Bitmask of the layers being redrawn by the current update
+		sf::DoubleRect drawn_bounds; ///< Bounds of the graph when the layers were last drawn
+
+		//On-demand rendering
+		bool on_demand; ///< If true the mainloop sleeps while nothing changes
+		bool animating; ///< If true the mainloop redraws continuously in on-demand mode
+		std::atomic<bool> update_requested; ///< Set to wake the mainloop
+		bool wait_for_update(sf::Event& event);
+
+		//Parallelism
+		std::unique_ptr<xsf::ThreadPool> pool; ///< Worker threads, created on first use
+		unsigned int threads; ///< Number of threads to create the pool with
+		xsf::ThreadPool& workers();
+
+		//Instrumentation
+		FrameStats frame_stats; ///< Statistics of the last update
+		GraphableStats* drawing_stats; ///< Statistics of the graphable currently being drawn
+		sf::Clock framerate_clock; ///< Time since the framerate was last calculated
+		unsigned int framerate_frames; ///< Number of updates since the framerate was last calculated
+
+		Viewport viewport(); ///< Returns a snapshot of the current bounds and size of the graph
+
 		//Convert from graph coordinates to window coordinates
 		//Absolute coordinates
 		sf::Vector2f map(double x, double y);
@@ -281,4 +480,13 @@ namespace graphy
 /// graph.mainloop();
 /// \endcode
 ///
+/// A graph can also be rendered offscreen without opening a
+/// window, for example to produce images in batch:
+/// \code
+/// graphy::Graph graph(640, 480);
+/// graph.add(eq);
+/// graph.update();
+/// graph.print("parabola.png");
+/// \endcode
+///
 ////////////////////////////////////////////////////////////
@@ -29,9 +29,13 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <SFML/Graphics.hpp>
+#include <atomic>
 #include <functional>
 #include <Graphy/Utils/Vector2d.hpp>
 #include <Graphy/Utils/DoubleRect.hpp>
+#include <Graphy/Utils/VertexBatch.hpp>
+#include <Graphy/Utils/Raster.hpp>
+#include <Graphy/Viewport.hpp>
 
 
 namespace graphy
@@ -54,6 +58,44 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		Graphable();
 
+		////////////////////////////////////////////////////////////
+		/// \brief Copy constructor
+		///
+		/// The copy is not added to the graph of \a other.
+		///
+		////////////////////////////////////////////////////////////
+		Graphable(const Graphable& other);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Copy assignment operator
+		///
+		/// The graphable stays on its own graph and is redrawn.
+		///
+		////////////////////////////////////////////////////////////
+		Graphable& operator=(const Graphable& other);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Marks the graphable as changed
+		///
+		/// With damage tracking enabled, a graph only redraws a 
+		/// graphable when its viewport or size changes, or when the
+		/// graphable has been invalidated.
+		/// This should be called after modifying the data or style
+		/// of a graphable which has been added to a graph. It also
+		/// discards anything the graphable has cached from previous
+		/// frames (see discard_cache()) and wakes a graph's mainloop
+		/// in on-demand mode.
+		///
+		/// It may be called from another thread while the graph is
+		/// updating, and the graphable is then redrawn on the next
+		/// update. Its data must not be modified while an update is
+		/// running though, since it is read by prepare() and draw()
+		/// on the graph's threads, so changes made from another 
+		/// thread must be synchronised with the mainloop.
+		///
+		////////////////////////////////////////////////////////////
+		virtual void invalidate();
+
 	protected:
 		////////////////////////////////////////////////////////////
 		/// \brief Pure virtual function which can be overriden to define how the graphable should be drawn
@@ -61,12 +103,57 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		virtual void draw() = 0;
 
+		////////////////////////////////////////////////////////////
+		/// \brief Virtual function which can be overriden to build the graphable's geometry before it is drawn
+		///
+		/// When a graph is updated, prepare() is called on every 
+		/// graphable which is to be redrawn in parallel on the graph's
+		/// worker threads, and afterwards draw() is called on each of
+		/// them in turn. prepare() may map coordinates, evaluate 
+		/// functions and read the size of the canvas, but must not 
+		/// draw to the canvas or use its font.
+		///
+		////////////////////////////////////////////////////////////
+		virtual void prepare();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Virtual function which can be overriden to discard values remembered from previous frames
+		///
+		/// Called by invalidate(), and by the graph before every 
+		/// update while damage tracking is disabled, so that a 
+		/// graphable whose function has changed without being 
+		/// invalidated is still evaluated afresh.
+		///
+		////////////////////////////////////////////////////////////
+		virtual void discard_cache();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Calls \a body for every index in [\a begin, \a end) on the graph's worker threads
+		///
+		/// This may be called from prepare() to split up expensive 
+		/// work, such as evaluating a function over a grid, and
+		/// returns once every call has finished. If the graphable
+		/// is not on a graph, \a body is called on this thread.
+		///
+		////////////////////////////////////////////////////////////
+		void parallel_for(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body);
+
 		////////////////////////////////////////////////////////////
 		/// \brief Returns the current bounds of the graph in graph coordinates
 		///
 		////////////////////////////////////////////////////////////
 		sf::DoubleRect& bounds();
 
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the transform between graph and window coordinates
+		///
+		/// The graph takes a snapshot of its viewport at the start of
+		/// each update and when the graphable is added, and the mapping
+		/// functions below use it. Its array functions map many 
+		/// points at once.
+		///
+		////////////////////////////////////////////////////////////
+		const Viewport& viewport() const;
 
 		sf::Vector2f map(double x, double y); ///< Maps a position in graph coordinates to a position in window coordinates
 		sf::Vector2f map(sf::Vector2d p); ///< Maps a position vector in graph coordinates to a position in window coordinates
@@ -88,6 +175,13 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		/// \brief Proxy object providing basic drawing tools
 		///
+		/// Triangles, quads, vertex arrays and untextured shapes drawn
+		/// to the canvas are collected into one batch per layer and
+		/// submitted together when the graph is updated, so drawing 
+		/// many small primitives is cheap. Graphables which colour 
+		/// the canvas pixel by pixel can instead fill a raster and
+		/// draw it as one textured quad.
+		///
 		////////////////////////////////////////////////////////////
 		struct Canvas
 		{
@@ -141,16 +235,61 @@ namespace graphy
 			////////////////////////////////////////////////////////////
 			void draw(Layer layer, const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default);
 
+			////////////////////////////////////////////////////////////
+			/// \brief Draws a raster to the graph, stretched over \a area
+			///
+			/// The pixels of the raster are uploaded to its texture,
+			/// which is drawn with the smoothing set in the raster. The
+			/// raster must not change until the graph has been updated.
+			///
+			/// \param raster The raster to be drawn
+			/// \param area Rectangle in window coordinates covered by the raster
+			///
+			////////////////////////////////////////////////////////////
+			void draw(Layer layer, xsf::Raster& raster, const sf::FloatRect& area);
+
 		private:
 			friend Graphable;
 			Canvas(Graphable* graphable);
+			void record(const xsf::VertexBatch& batch, std::size_t submitted, std::size_t capacity); ///< Adds a draw call to the statistics of the graphable
 			Graphable* graphable;
 		} canvas; ///< Provides a minimal public interface to drawing functions for the graph's canvas
 	private:
 		friend Graph;
 		Graph* graph;
+		Viewport view; ///< Snapshot of the graph's viewport
+		std::atomic<bool> dirty; ///< True if the graphable has changed since it was last drawn, which may be set from another thread
+		unsigned char layer_mask; ///< Bitmask of the layers the graphable drew to when it was last drawn
 	};
 
+	inline const Viewport& Graphable::viewport() const { return view; }
+
+	//Convert from graph coordinates to window coordinates
+
+	//Absolute coordinates
+	inline sf::Vector2f Graphable::map(double x, double y) { return view.map(x, y); }
+	inline sf::Vector2f Graphable::map(sf::Vector2d p) { return view.map(p); }
+	inline float Graphable::map_x(double x) { return view.map_x(x); }
+	inline float Graphable::map_y(double y) { return view.map_y(y); }
+	//Relative coordinates
+	inline sf::Vector2f Graphable::rmap(double x, double y) { return view.rmap(x, y); }
+	inline sf::Vector2f Graphable::rmap(sf::Vector2d p) { return view.rmap(p); }
+	inline float Graphable::rmap_x(double x) { return view.rmap_x(x); }
+	inline float Graphable::rmap_y(double y) { return view.rmap_y(y); }
+
+	//Convert from window coordinates to graph coordinates
+
+	//Absolute coordinates
+	inline sf::Vector2d Graphable::amap(float x, float y) { return view.amap(x, y); }
+	inline sf::Vector2d Graphable::amap(sf::Vector2f p) { return view.amap(p); }
+	inline double Graphable::amap_x(float x) { return view.amap_x(x); }
+	inline double Graphable::amap_y(float y) { return view.amap_y(y); }
+	//Relative coordinates
+	inline sf::Vector2d Graphable::armap(float x, float y) { return view.armap(x, y); }
+	inline sf::Vector2d Graphable::armap(sf::Vector2f p) { return view.armap(p); }
+	inline double Graphable::armap_x(float x) { return view.armap_x(x); }
+	inline double Graphable::armap_y(float y) { return view.armap_y(y); }
+
 } // namespace graphy
 
 #endif //GRAPHY_GRAPHABLE_H
@@ -5,4 +5,6 @@
 #include <Graphy/Graphables/Equation.hpp>
 #include <Graphy/Graphables/Histogram.hpp>
 #include <Graphy/Graphables/ImplicitEquation.hpp>
+#include <Graphy/Graphables/ParametricCurve.hpp>
 #include <Graphy/Graphables/Point.hpp>
+#include <Graphy/Graphables/PolarCurve.hpp>
@@ -29,6 +29,8 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <Graphy/Graphable.hpp>
+#include <Graphy/Expression.hpp>
+#include <vector>
 
 
 namespace graphy
@@ -51,17 +53,108 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		ColorMap(std::function<sf::Color(double, double)> eq);
 
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs a color map from expressions of x and y giving
+		/// the red, green and blue components of the color between 
+		/// 0 and 1, which are evaluated a row of points at a time.
+		///
+		/// \param red Expression of the red component
+		/// \param green Expression of the green component
+		/// \param blue Expression of the blue component
+		///
+		////////////////////////////////////////////////////////////
+		ColorMap(const Expression& red, const Expression& green, const Expression& blue);
+
 		std::function<sf::Color(double, double)> eq; ///< Equation of the color map
+		std::function<void(const double*, double, sf::Color*, std::size_t)> batch_eq; ///< Equation of the color map evaluated along a row of points: f(x, y, result, count), used instead of \a eq if set
 		float grain_size; ///< Distance in pixels between points at which the equation is evaluated
+		bool smooth; ///< If true colors are interpolated between the points at which the equation is evaluated, otherwise each cell is one color
 
 	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the color map along a row of points
+		///
+		/// \param x Array of \a count x-values
+		/// \param y y-value shared by every point
+		/// \param result Array of \a count colors to receive the color at each point
+		/// \param count Number of points
+		///
+		////////////////////////////////////////////////////////////
+		virtual void evaluate(const double* x, double y, sf::Color* result, std::size_t count) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Defines how the graphable is drawn to the graph
 		///
 		////////////////////////////////////////////////////////////
 		void draw();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the color map over the canvas
+		///
+		/// The canvas is split into tiles which are evaluated on the
+		/// graph's worker threads, so the equation may be called 
+		/// from several threads at once. Each point becomes one 
+		/// pixel of a raster, which is drawn scaled up by grain_size.
+		///
+		////////////////////////////////////////////////////////////
+		void prepare();
+
+	private:
+		xsf::Raster image; ///< Color of each cell
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Color map whose function is stored as its own type
+	///
+	/// Unlike a std::function, calls to \a function can be 
+	/// inlined into the loop which evaluates the grid. Use
+	/// make_color_map() to construct one from a lambda.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	class FunctionColorMap : public ColorMap
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param function A callable taking x and y and returning an sf::Color
+		///
+		////////////////////////////////////////////////////////////
+		FunctionColorMap(F function) :
+			ColorMap(std::function<sf::Color(double, double)>()), function(function)
+		{
+
+		}
+
+		F function; ///< Function of the color map, used instead of \a eq
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates \a function along a row of points
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, double y, sf::Color* result, std::size_t count) const
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				result[i] = function(x[i], y);
+		}
 	};
 
+	////////////////////////////////////////////////////////////
+	/// \brief Constructs a color map which calls \a function directly
+	///
+	/// \param function A callable taking x and y and returning an sf::Color
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	FunctionColorMap<F> make_color_map(F function)
+	{
+		return FunctionColorMap<F>(function);
+	}
+
 } // namespace graphy
 
 #endif //GRAPHY_COLORMAP_H
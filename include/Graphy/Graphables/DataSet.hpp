@@ -31,6 +31,7 @@
 #include <Graphy/Graphables/Point.hpp>
 #include <Graphy/Graphable.hpp>
 #include <vector>
+#include <utility>
 #include <Graphy/Graphables/Styles/LineStyle.hpp>
 
 
@@ -98,6 +99,39 @@ namespace graphy
 		///
 		////////////////////////////////////////////////////////////
 		void draw();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps the data points and builds their geometry
+		///
+		////////////////////////////////////////////////////////////
+		void prepare();
+
+	private:
+		////////////////////////////////////////////////////////////
+		/// \brief Point shape tessellated into triangles
+		///
+		////////////////////////////////////////////////////////////
+		struct Marker
+		{
+			sf::ConvexShape shape; ///< Shape the marker was tessellated from
+			float outline; ///< Outline thickness the marker was tessellated with
+			float extent; ///< Largest distance along either axis from the point to the edge of the marker
+			std::vector<sf::Vertex> triangles; ///< Triangles of the marker relative to the point
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the tessellated marker of a point style, tessellating it if it is not cached
+		///
+		////////////////////////////////////////////////////////////
+		const Marker& marker(const PointStyle& style);
+
+		std::vector<Marker> markers; ///< Cache of the distinct point shapes which have been drawn
+		std::size_t last_marker; ///< Index of the most recently used marker
+		std::vector<double> graph_x, graph_y; ///< Graph coordinates of every point, gathered to be mapped together
+		std::vector<float> window_x, window_y; ///< Window coordinates of every point
+		std::vector<sf::Vertex> instances; ///< Triangles of every point marker drawn in a frame
+		sf::VertexArray line; ///< Triangle strip joining the points
+		std::vector<std::pair<std::size_t, sf::Vector2f>> labelled; ///< Index and position of each visible point with a label
 	};
 
 } // namespace graphy
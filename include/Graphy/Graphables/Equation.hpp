@@ -29,8 +29,12 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <functional>
+#include <vector>
+#include <unordered_map>
 #include <SFML/Graphics.hpp>
 #include <Graphy/Graphable.hpp>
+#include <Graphy/Expression.hpp>
+#include <Graphy/Dual.hpp>
 #include <Graphy/Graphables/Styles/LineStyle.hpp>
 
 namespace graphy
@@ -42,6 +46,9 @@ namespace graphy
 	struct Equation : public Graphable
 	{
 	public:
+		typedef std::function<void(const double*, double*, std::size_t)> BatchFunction; ///< Function writing y-values for an array of x-values: f(x, y, count)
+		typedef std::function<bool(double, double*, unsigned int)> DerivativeFunction; ///< Function writing the value and first n derivatives at x exactly: f(x, result, n), returning false if it cannot
+
 		////////////////////////////////////////////////////////////
 		/// \brief Constructor
 		///
@@ -54,6 +61,30 @@ namespace graphy
 			std::function<double(double)> equation = [](double x) { return x;},
 			LineStyle style = LineStyle());
 
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs an equation from a function which evaluates the
+		/// formula at many x-values in one call. The curve is drawn,
+		/// differentiated and solved by evaluating arrays of points 
+		/// wherever possible.
+		///
+		/// \param batch_equation A function writing the value of the equation at each of \a count x-values to an array of y-values
+		///
+		////////////////////////////////////////////////////////////
+		Equation(BatchFunction batch_equation, LineStyle style = LineStyle());
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs an equation from an expression of x, which is 
+		/// evaluated at arrays of points and differentiated exactly.
+		///
+		/// \param expression Expression whose first variable is x
+		///
+		////////////////////////////////////////////////////////////
+		Equation(const Expression& expression, LineStyle style = LineStyle());
+
 		////////////////////////////////////////////////////////////
 		/// \brief Default destructor
 		///
@@ -89,6 +120,67 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		double x(double y, double x0, unsigned its = 5) const;
 
+		////////////////////////////////////////////////////////////
+		/// \brief Finds every x-value in view at which the equation has the value \a y
+		///
+		/// The curve sampled for the last frame is searched for 
+		/// intervals in which the equation crosses \a y, and each 
+		/// interval is narrowed to a root with Brent's method. 
+		/// Crossings at poles and jumps are discarded, and points 
+		/// where the curve touches \a y without crossing it are only
+		/// found if a sample lands on them.
+		///
+		/// \param y y-value at which to find the corresponding x-values
+		///
+		/// \return The x-values in ascending order
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<double> roots(double y = 0) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds every x-value between \a left and \a right at which the equation has the value \a y
+		///
+		/// The curve sampled for the last frame is used if it 
+		/// covers the range, otherwise the range is sampled every
+		/// grain_size pixels at the current scale, or at 
+		/// max_evaluations equal steps if that would take more. 
+		/// Roots closer together than a step may then be missed.
+		///
+		/// \param y y-value at which to find the corresponding x-values
+		/// \param left Smallest x-value to search
+		/// \param right Largest x-value to search
+		///
+		/// \return The x-values in ascending order
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<double> roots(double y, double left, double right) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds every x-value in view at which the equation has each of the values \a ys
+		///
+		/// The curve is searched once for all of the values, and 
+		/// the roots are refined together so that each step of
+		/// Brent's method evaluates the equation in one call.
+		///
+		/// \param ys y-values at which to find the corresponding x-values
+		///
+		/// \return The x-values in ascending order for each y-value
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<std::vector<double>> roots(const std::vector<double>& ys) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds every x-value between \a left and \a right at which the equation has each of the values \a ys
+		///
+		/// \param ys y-values at which to find the corresponding x-values
+		/// \param left Smallest x-value to search
+		/// \param right Largest x-value to search
+		///
+		/// \return The x-values in ascending order for each y-value
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<std::vector<double>> roots(const std::vector<double>& ys, double left, double right) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Calculate the derivitive of the equation at a point
 		///
@@ -100,16 +192,55 @@ namespace graphy
 		////////////////////////////////////////////////////////////
 		/// \brief Calculate the n-th derivitive of the equation at a point
 		///
+		/// The derivative is exact if the equation can be 
+		/// differentiated automatically, and is otherwise estimated
+		/// by a central difference of n + 1 values of the equation.
+		///
 		/// \param x x-value at which to evaulate the n-th derivitive of the equation
 		///
 		////////////////////////////////////////////////////////////
 		double dn_y(unsigned int n, double x) const;
 
 		std::function<double(double)> equation; ///< The equation of the curve
+		BatchFunction batch_equation; ///< The equation of the curve evaluated at many points at once, used instead of \a equation if set
+		DerivativeFunction derivative_equation; ///< Exact derivatives of the equation, used instead of finite differences if set
 		LineStyle style; ///< Styling information for the curve
-		float grain_size; ///< Number of pixels between points where the curve is calculated
+		float grain_size; ///< Largest number of pixels between points where the curve is calculated
+		float tolerance; ///< Largest distance in pixels between the drawn line and the curve before it is sampled more finely
+		unsigned int max_evaluations; ///< Largest number of points sampled to draw the curve, including those remembered from previous frames
+		const Equation* fill_to; ///< If set, the inequality region is filled between this curve and \a fill_to rather than to the edge of the window
 
 	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the equation at an array of x-values
+		///
+		/// Every other function of the equation evaluates it through
+		/// this, which calls \a batch_equation if it is set and
+		/// \a equation otherwise.
+		///
+		/// \param x Array of \a count x-values
+		/// \param y Array of \a count values to receive the value of the equation at each x-value
+		/// \param count Number of x-values
+		///
+		////////////////////////////////////////////////////////////
+		virtual void evaluate(const double* x, double* y, std::size_t count) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Calculates the value and first \a n derivatives of the equation exactly
+		///
+		/// This calls \a derivative_equation if it is set. dy(), 
+		/// dn_y() and x() fall back to finite differences when it 
+		/// returns false.
+		///
+		/// \param x x-value at which to differentiate the equation
+		/// \param result Array of \a n + 1 values to receive the value and each derivative
+		/// \param n Number of derivatives to calculate
+		///
+		/// \return False if the equation cannot be differentiated exactly
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool derivatives(double x, double* result, unsigned int n) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Defines how the graphable is drawn to the graph
 		///
@@ -117,21 +248,188 @@ namespace graphy
 		void draw();
 
 		////////////////////////////////////////////////////////////
-		/// \brief Recursively calculates the n-th derivative from an array of values in the region
+		/// \brief Samples the curve and builds its geometry
+		///
+		/// The curve is first sampled every grain_size pixels, then
+		/// segments are repeatedly halved wherever the curve bends
+		/// away from a straight line by more than tolerance, until
+		/// max_evaluations is reached. The line is broken at poles,
+		/// jumps and the edges of the curve's domain.
 		///
-		/// \param n Current order of the derivative
-		/// \param ys An array containing n values of the curve in the proximity of where the derivitive is being calculated
+		/// The inequality region is a single triangle strip through
+		/// the same points, closed against the edge of the window or
+		/// against \a fill_to evaluated at the same x-values.
+		///
+		/// Samples are taken on a grid fixed in graph coordinates and
+		/// their values are kept, so after panning only the newly
+		/// exposed part of the curve is evaluated. Zooming or 
+		/// resizing changes the grid and discards the values.
 		///
 		////////////////////////////////////////////////////////////
-		double dn_rec(unsigned int n, double* ys) const;
+		void prepare();
 
 		////////////////////////////////////////////////////////////
-		/// \brief Interval used to calculate derivaties
+		/// \brief Discards the values of the equation remembered from previous frames
+		///
+		/// invalidate() calls this, so it must be called after 
+		/// changing \a equation unless damage tracking is disabled.
 		///
 		////////////////////////////////////////////////////////////
-		static const double delta;
+		void discard_cache();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds the points on the curve at x = cache_anchor + key * cache_step in window coordinates
+		///
+		/// The equation is evaluated in one call at every key whose
+		/// value is not cached.
+		///
+		////////////////////////////////////////////////////////////
+		void sample(const std::vector<long long>& keys, std::vector<sf::Vector2f>& result);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds values of the equation spanning \a left to \a right, in ascending order of x
+		///
+		/// The points sampled for the last frame are used if they 
+		/// cover the range. Values at breaks in the line are NaN.
+		///
+		////////////////////////////////////////////////////////////
+		void scan(double left, double right, std::vector<double>& x, std::vector<double>& y) const;
+
+	private:
+		std::vector<sf::Vector2f> points; ///< Points sampled along the curve
+		std::vector<long long> keys; ///< Grid index of each point
+		std::vector<bool> refine; ///< True for each segment between points which is to be halved
+		std::vector<sf::Vector2f> next_points; ///< Points of the next level of refinement
+		std::vector<long long> next_keys; ///< Grid index of each point of the next level of refinement
+		std::vector<long long> mid_keys; ///< Grid index of the midpoint of each segment being halved
+		std::vector<sf::Vector2f> mid_points; ///< Midpoint of each segment being halved
+		std::vector<long long> missing; ///< Grid indices being evaluated
+		std::vector<double> missing_x, missing_y; ///< Values being evaluated
+		std::vector<bool> next_refine; ///< Segments to be halved at the next level of refinement
+		std::unordered_map<long long, double> cache; ///< Values of the equation at each grid index sampled
+		double cache_step; ///< Distance in graph coordinates between grid indices
+		double cache_anchor; ///< Graph x-value of grid index 0
+		sf::VertexArray curve; ///< Triangle strip of the curve
+		std::vector<double> fill_x, fill_y; ///< Values of fill_to at each point
+		sf::VertexArray region; ///< Triangle strip filling the inequality region
+		sf::Vector2f label_position; ///< Point on the curve which the label is placed against
 	};
 
+	////////////////////////////////////////////////////////////
+	/// \brief Equation whose formula is stored as its own type
+	///
+	/// Unlike a std::function, calls to \a function can be 
+	/// inlined into the loops which sample the curve. Use
+	/// make_equation() to construct one from a lambda.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	struct FunctionEquation : public Equation
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param function A callable taking and returning a double
+		///
+		////////////////////////////////////////////////////////////
+		FunctionEquation(F function, LineStyle style = LineStyle()) :
+			Equation(std::function<double(double)>(), style), function(function)
+		{
+
+		}
+
+		F function; ///< The equation of the curve, used instead of \a equation
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates \a function at an array of x-values
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, double* y, std::size_t count) const
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				y[i] = function(x[i]);
+		}
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Constructs an equation which calls \a function directly
+	///
+	/// \code
+	/// auto eq = graphy::make_equation([](double x) { return x*x; });
+	/// graph.add(eq);
+	/// \endcode
+	///
+	/// \param function A callable taking and returning a double
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	FunctionEquation<F> make_equation(F function, LineStyle style = LineStyle())
+	{
+		return FunctionEquation<F>(function, style);
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Equation whose formula is templated on its argument type
+	///
+	/// Derivatives of the equation, and the slopes used to solve it
+	/// in x(), are calculated exactly with dual numbers rather than
+	/// by finite differences. \a function must accept doubles and 
+	/// dual numbers nested up to max_dual_order times, and should 
+	/// call functions unqualified (sin rather than std::sin). Use
+	/// make_differentiable_equation() to construct one.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	struct DifferentiableEquation : public FunctionEquation<F>
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param function A callable templated on its argument type
+		///
+		////////////////////////////////////////////////////////////
+		DifferentiableEquation(F function, LineStyle style = LineStyle()) :
+			FunctionEquation<F>(function, style)
+		{
+
+		}
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Differentiates \a function with dual numbers
+		///
+		////////////////////////////////////////////////////////////
+		bool derivatives(double x, double* result, unsigned int n) const
+		{
+			return differentiate(this->function, x, result, n);
+		}
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Constructs an equation which is differentiated exactly
+	///
+	/// \code
+	/// struct Gaussian
+	/// {
+	///     template <typename T>
+	///     T operator()(const T& x) const { return exp(-x*x / 2); }
+	/// };
+	/// auto eq = graphy::make_differentiable_equation(Gaussian());
+	/// double slope = eq.dy(1);
+	/// \endcode
+	///
+	/// \param function A callable templated on its argument type
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	DifferentiableEquation<F> make_differentiable_equation(F function, LineStyle style = LineStyle())
+	{
+		return DifferentiableEquation<F>(function, style);
+	}
+
 } // namespace graphy
 
 #endif //GRAPHY_EQUATION_H
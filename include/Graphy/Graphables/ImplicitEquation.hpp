@@ -29,7 +29,10 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <Graphy/Graphable.hpp>
+#include <Graphy/Expression.hpp>
+#include <Graphy/Interval.hpp>
 #include <functional>
+#include <vector>
 #include <Graphy/Graphables/Styles/LineStyle.hpp>
 
 
@@ -41,6 +44,9 @@ namespace graphy
 	////////////////////////////////////////////////////////////
 	struct ImplicitEquation : public Graphable
 	{
+		typedef std::function<void(const double*, double, double*, std::size_t)> BatchFunction; ///< Function writing values for a row of points: f(x, y, result, count)
+		typedef std::function<Interval(const Interval&, const Interval&)> IntervalFunction; ///< Function bounding the equation over a box: f(x, y)
+
 		////////////////////////////////////////////////////////////
 		/// \brief Constructor
 		///
@@ -53,28 +59,290 @@ namespace graphy
 			std::function<double(double, double)> equation = [](double x, double y) { return x*x + y*y - 1; },
 			LineStyle style = LineStyle());
 
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs an equation from an expression of x and y 
+		/// which equals 0 along the curve, and is evaluated a row of
+		/// points at a time. The expression is also bounded with 
+		/// interval arithmetic to skip empty parts of the canvas.
+		///
+		/// \param expression Expression whose first two variables are x and y
+		///
+		////////////////////////////////////////////////////////////
+		ImplicitEquation(const Expression& expression, LineStyle style = LineStyle());
+
 		std::function<double(double, double)> equation; ///< The equation of the curve
+		BatchFunction batch_equation; ///< The equation of the curve evaluated along a row of points, used instead of \a equation if set
+		IntervalFunction interval_equation; ///< Bounds of the equation over a box, used to skip boxes the curve does not pass through if set
 		LineStyle style;  ///< Styling information for the curve
-		float grain_size;
+		float grain_size; ///< Distance in pixels between the points of the grid on which the equation is evaluated
+		bool trace; ///< If true the curve is followed from where it crosses a coarse grid instead of being extracted from the full grid, unless the inequality region is shown
+		float trace_spacing; ///< Distance in pixels between the points of the coarse grid used to find the curve when tracing
 
 		////////////////////////////////////////////////////////////
 		/// \brief Reposition the label to be as close to the position defined in style as possible
 		///
+		/// The label is placed on the lines extracted by the last
+		/// call to prepare(), which calls this whenever it rebuilds
+		/// them, so the equation is not evaluated again.
+		///
 		////////////////////////////////////////////////////////////
 		void reposition_label();
 
 	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the equation along a row of points
+		///
+		/// \param x Array of \a count x-values
+		/// \param y y-value shared by every point
+		/// \param result Array of \a count values to receive the value of the equation at each point
+		/// \param count Number of points
+		///
+		////////////////////////////////////////////////////////////
+		virtual void evaluate(const double* x, double y, double* result, std::size_t count) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Bounds the equation over a box
+		///
+		/// \param x Interval of x-values of the box
+		/// \param y Interval of y-values of the box
+		/// \param result Interval to receive the bounds of the equation within the box
+		///
+		/// \return False if the equation cannot be bounded
+		///
+		////////////////////////////////////////////////////////////
+		virtual bool bound(const Interval& x, const Interval& y, Interval& result) const;
+
 		////////////////////////////////////////////////////////////
 		/// \brief Defines how the graphable is drawn to the graph
 		///
 		////////////////////////////////////////////////////////////
 		void draw();
 
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the equation over the canvas and extracts the curve
+		///
+		/// The equation is evaluated on a grid of points grain_size
+		/// apart. If it can be bounded, the canvas is first divided
+		/// into a quadtree and boxes in which the equation provably
+		/// keeps one sign are skipped, or filled whole if they are in
+		/// the inequality region, so that only the grid near the 
+		/// curve is evaluated. Wherever its sign changes along an 
+		/// edge of the grid the crossing is interpolated, improved 
+		/// with a few steps of the false position method and 
+		/// discarded if it turns out to be a pole or a jump. The 
+		/// crossings are joined cell by cell with marching squares
+		/// into lines, which are drawn at the thickness of the style.
+		/// The inequality region is filled up to the same crossings.
+		///
+		/// The grid is evaluated in tiles and the crossings are found
+		/// on the graph's worker threads, so the equation may be 
+		/// called from several threads at once.
+		///
+		/// When tracing, the grid is trace_spacing apart and each 
+		/// crossing on it is used as a seed from which the curve is
+		/// followed both ways, so the cost grows with the length of
+		/// the curve in pixels rather than the area of the canvas. 
+		/// Loops which fit between the points of the coarse grid may
+		/// be missed.
+		///
+		////////////////////////////////////////////////////////////
+		void prepare();
+
 	private:
-		sf::Vector2d label_pos_; 
-		bool label_pos_set;
+		////////////////////////////////////////////////////////////
+		/// \brief Finds where the curve crosses the edge between grid points \a a and \a b
+		///
+		/// \param edge Index of the edge
+		/// \param a Window coordinates of the first point
+		/// \param b Window coordinates of the second point
+		/// \param va Value of the equation at \a a
+		/// \param vb Value of the equation at \a b
+		///
+		////////////////////////////////////////////////////////////
+		void cross(std::size_t edge, sf::Vector2f a, sf::Vector2f b, double va, double vb);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Adds the polygon of the part of a cell inside the inequality region to \a region
+		///
+		/// \param corners Window coordinates of the corners in clockwise order from the top left
+		/// \param values Value of the equation at each corner
+		/// \param edges Index of the edge following each corner
+		/// \param centre Value of the equation at the centre of the cell, estimated from the corners
+		///
+		////////////////////////////////////////////////////////////
+		void fill_cell(const sf::Vector2f* corners, const double* values, const std::size_t* edges, double centre);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the equation and its gradient at a point
+		///
+		/// \param p Window coordinates of the point
+		/// \param value Value of the equation at \a p
+		/// \param gradient Gradient of the equation per pixel at \a p, estimated with central differences
+		///
+		/// \return False if the value or gradient is not finite or the gradient is zero
+		///
+		////////////////////////////////////////////////////////////
+		bool differentiate(const sf::Vector2d& p, double& value, sf::Vector2d& gradient) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Moves a point onto the curve with Newton's method
+		///
+		/// \param p Window coordinates of the point, which receives the point on the curve
+		/// \param gradient Gradient of the equation per pixel near the point on the curve
+		///
+		/// \return False if the point could not be moved onto the curve
+		///
+		////////////////////////////////////////////////////////////
+		bool correct(sf::Vector2d& p, sf::Vector2d& gradient) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Follows the curve both ways from a seed and adds it to \a lines
+		///
+		/// Edges of the coarse grid which the curve crosses on the 
+		/// way are marked in \a traced so they are not used as seeds.
+		///
+		/// \param seed Window coordinates of a point near the curve
+		/// \param spacing Distance in pixels between the points of the coarse grid
+		/// \param nx Number of columns of points of the coarse grid
+		/// \param ny Number of rows of points of the coarse grid
+		///
+		////////////////////////////////////////////////////////////
+		void trace_line(sf::Vector2d seed, float spacing, std::size_t nx, std::size_t ny);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Marks the edges of the coarse grid crossed by the segment from \a a to \a b in \a traced
+		///
+		////////////////////////////////////////////////////////////
+		void mark(const sf::Vector2d& a, const sf::Vector2d& b, float spacing, std::size_t nx, std::size_t ny);
+
+		sf::Vector2f label_position; ///< Point on the curve which the label is placed against
+		bool label_found; ///< False if no part of the curve is near enough to the position of the label
+		std::vector<std::size_t> cells; ///< Index of each cell of the grid which the curve may pass through, a row at a time
+		std::vector<unsigned char> needed; ///< True for each point of the grid which is the corner of a cell in \a cells
+		std::vector<double> values; ///< Value of the equation at each point of the grid, a row at a time
+		std::vector<sf::Vector2f> crossings; ///< Point at which the curve crosses each edge of the grid
+		std::vector<unsigned char> tested; ///< True for each edge of the grid which has been checked for a crossing
+		std::vector<std::size_t> pending; ///< Edges of the grid whose ends have different signs
+		std::vector<unsigned char> crossed; ///< True for each edge of the grid which the curve crosses
+		std::vector<std::pair<std::size_t, std::size_t>> segments; ///< Pairs of edges joined by a segment of the curve
+		std::vector<int> links; ///< Indices of the two segments which meet at each edge, or -1
+		std::vector<unsigned char> joined; ///< True for each segment which has been added to a line
+		std::vector<unsigned char> traced; ///< True for each edge of the coarse grid which a traced line has crossed
+		std::vector<sf::Vector2d> path; ///< Points of the line being traced
+		std::vector<sf::Vector2f> lines; ///< Points of the curve with NaN between separate lines
+		sf::VertexArray curve; ///< Triangle strip of the curve
+		std::vector<sf::Vertex> region; ///< Triangles filling the inequality region
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Implicit equation whose formula is stored as its own type
+	///
+	/// Unlike a std::function, calls to \a function can be 
+	/// inlined into the loop which evaluates the grid. Use
+	/// make_implicit_equation() to construct one from a lambda.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	struct FunctionImplicitEquation : public ImplicitEquation
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param function A callable taking x and y and returning a double which is 0 along the curve
+		///
+		////////////////////////////////////////////////////////////
+		FunctionImplicitEquation(F function, LineStyle style = LineStyle()) :
+			ImplicitEquation(std::function<double(double, double)>(), style), function(function)
+		{
+
+		}
+
+		F function; ///< The equation of the curve, used instead of \a equation
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates \a function along a row of points
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* x, double y, double* result, std::size_t count) const
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				result[i] = function(x[i], y);
+		}
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Constructs an implicit equation which calls \a function directly
+	///
+	/// \param function A callable taking x and y and returning a double which is 0 along the curve
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	FunctionImplicitEquation<F> make_implicit_equation(F function, LineStyle style = LineStyle())
+	{
+		return FunctionImplicitEquation<F>(function, style);
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Implicit equation which is bounded with interval arithmetic
+	///
+	/// \a function must accept both doubles and Intervals. Parts 
+	/// of the canvas where its bounds show it keeps one sign are
+	/// not evaluated, so the cost of drawing the curve grows with
+	/// its length rather than the area of the canvas. Use 
+	/// make_interval_implicit_equation() to construct one.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	struct IntervalImplicitEquation : public FunctionImplicitEquation<F>
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param function A callable templated on its argument type
+		///
+		////////////////////////////////////////////////////////////
+		IntervalImplicitEquation(F function, LineStyle style = LineStyle()) :
+			FunctionImplicitEquation<F>(function, style)
+		{
+
+		}
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Bounds \a function with interval arithmetic
+		///
+		////////////////////////////////////////////////////////////
+		bool bound(const Interval& x, const Interval& y, Interval& result) const
+		{
+			result = this->function(x, y);
+			return true;
+		}
 	};
 
+	////////////////////////////////////////////////////////////
+	/// \brief Constructs an implicit equation which is bounded with interval arithmetic
+	///
+	/// \code
+	/// struct Circle
+	/// {
+	///     template <typename T>
+	///     T operator()(const T& x, const T& y) const { return x*x + y*y - 1; }
+	/// };
+	/// auto eq = graphy::make_interval_implicit_equation(Circle());
+	/// \endcode
+	///
+	/// \param function A callable templated on its argument type
+	///
+	////////////////////////////////////////////////////////////
+	template <typename F>
+	IntervalImplicitEquation<F> make_interval_implicit_equation(F function, LineStyle style = LineStyle())
+	{
+		return IntervalImplicitEquation<F>(function, style);
+	}
+
 } // namespace graphy
 
 #endif //GRAPHY_IMPLICITEQUATION_H
@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_PARAMETRICCURVE_H
+#define GRAPHY_PARAMETRICCURVE_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cmath>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+#include <SFML/Graphics.hpp>
+#include <Graphy/Graphable.hpp>
+#include <Graphy/Graphables/Styles/LineStyle.hpp>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Graphable representing a curve (x(t), y(t)) traced by a parameter t
+	///
+	////////////////////////////////////////////////////////////
+	struct ParametricCurve : public Graphable
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs the curve traced by (x_equation(t), y_equation(t))
+		/// as t goes from \a start to \a end.
+		///
+		/// \param x_equation A function giving the x-value of the curve at each value of the parameter
+		/// \param y_equation A function giving the y-value of the curve at each value of the parameter
+		/// \param start First value of the parameter
+		/// \param end Last value of the parameter
+		///
+		////////////////////////////////////////////////////////////
+		ParametricCurve(
+			std::function<double(double)> x_equation = [](double t) { return std::cos(t); },
+			std::function<double(double)> y_equation = [](double t) { return std::sin(t); },
+			double start = 0,
+			double end = 6.28318530717958647692,
+			LineStyle style = LineStyle());
+
+		////////////////////////////////////////////////////////////
+		/// \brief Return the point on the curve at a value of the parameter
+		///
+		/// \param t Value of the parameter
+		///
+		////////////////////////////////////////////////////////////
+		sf::Vector2d point(double t) const;
+
+		std::function<double(double)> x_equation; ///< x-value of the curve at each value of the parameter
+		std::function<double(double)> y_equation; ///< y-value of the curve at each value of the parameter
+		double start; ///< First value of the parameter
+		double end; ///< Last value of the parameter
+		LineStyle style; ///< Styling information for the curve. The label is placed at the point where the parameter equals style.label.x
+		unsigned int samples; ///< Number of equal steps of the parameter at which the curve is first sampled
+		float tolerance; ///< Largest distance in pixels between the drawn line and the curve before it is sampled more finely
+		unsigned int max_evaluations; ///< Largest number of points sampled to draw the curve, including those remembered from previous frames
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the curve at an array of values of the parameter
+		///
+		/// \param t Array of \a count values of the parameter
+		/// \param x Array of \a count values to receive the x-value of each point
+		/// \param y Array of \a count values to receive the y-value of each point
+		/// \param count Number of values of the parameter
+		///
+		////////////////////////////////////////////////////////////
+		virtual void evaluate(const double* t, double* x, double* y, std::size_t count) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Defines how the graphable is drawn to the graph
+		///
+		////////////////////////////////////////////////////////////
+		void draw();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Samples the curve and builds its geometry
+		///
+		/// The curve is first sampled at \a samples equal steps of the
+		/// parameter, then segments are repeatedly halved wherever 
+		/// the curve bends away from a straight line on screen by more
+		/// than tolerance, until max_evaluations is reached. Segments 
+		/// outside the window are neither refined nor drawn, and the 
+		/// line is broken where the curve jumps or leaves its domain.
+		///
+		/// Points are kept in graph coordinates between frames, so 
+		/// panning and zooming only evaluate the curve where it needs
+		/// to be sampled more finely than before.
+		///
+		////////////////////////////////////////////////////////////
+		void prepare();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Discards the points of the curve remembered from previous frames
+		///
+		/// invalidate() calls this, so it must be called after 
+		/// changing the equations unless damage tracking is disabled.
+		///
+		////////////////////////////////////////////////////////////
+		void discard_cache();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds the points on the curve at t = start + key * (end - start) / cache_keys in window coordinates
+		///
+		/// The curve is evaluated in one call at every key whose 
+		/// point is not cached.
+		///
+		////////////////////////////////////////////////////////////
+		void sample(const std::vector<long long>& keys, std::vector<sf::Vector2f>& result);
+
+	private:
+		std::vector<sf::Vector2f> points; ///< Points sampled along the curve
+		std::vector<long long> keys; ///< Parameter index of each point
+		std::vector<bool> refine; ///< True for each segment between points which is to be halved
+		std::vector<sf::Vector2f> next_points; ///< Points of the next level of refinement
+		std::vector<long long> next_keys; ///< Parameter index of each point of the next level of refinement
+		std::vector<long long> mid_keys; ///< Parameter index of the midpoint of each segment being halved
+		std::vector<sf::Vector2f> mid_points; ///< Midpoint of each segment being halved
+		std::vector<long long> missing; ///< Parameter indices being evaluated
+		std::vector<double> missing_t, missing_x, missing_y; ///< Values being evaluated
+		std::vector<bool> next_refine; ///< Segments to be halved at the next level of refinement
+		std::vector<sf::Vector2f> visible; ///< Points of the parts of the curve in the window, separated by NaN
+		std::unordered_map<long long, sf::Vector2d> cache; ///< Point of the curve at each parameter index sampled
+		double cache_start, cache_end; ///< Range of the parameter when the cache was filled
+		long long cache_keys; ///< Number of parameter indices between start and end
+		sf::VertexArray curve; ///< Triangle strip of the curve
+		sf::Vector2f label_position; ///< Point on the curve which the label is placed against
+	};
+
+} // namespace graphy
+
+#endif //GRAPHY_PARAMETRICCURVE_H
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_POLARCURVE_H
+#define GRAPHY_POLARCURVE_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <functional>
+#include <Graphy/Graphables/ParametricCurve.hpp>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Graphable representing a curve r = f(theta) in polar coordinates
+	///
+	/// The curve is sampled in the same way as a ParametricCurve
+	/// with theta as the parameter, so \a start, \a end and the
+	/// sampling settings are inherited from it.
+	///
+	////////////////////////////////////////////////////////////
+	struct PolarCurve : public ParametricCurve
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs the curve with radius equation(theta) as theta 
+		/// goes from \a start to \a end.
+		///
+		/// \param equation A function giving the radius of the curve at each angle in radians
+		/// \param start First angle
+		/// \param end Last angle
+		///
+		////////////////////////////////////////////////////////////
+		PolarCurve(
+			std::function<double(double)> equation = [](double theta) { return 1; },
+			double start = 0,
+			double end = 6.28318530717958647692,
+			LineStyle style = LineStyle());
+
+		std::function<double(double)> equation; ///< Radius of the curve at each angle
+
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief Evaluates the radius at an array of angles and converts them to points
+		///
+		////////////////////////////////////////////////////////////
+		void evaluate(const double* theta, double* x, double* y, std::size_t count) const;
+	};
+
+} // namespace graphy
+
+#endif //GRAPHY_POLARCURVE_H
@@ -1,2 +1,5 @@
 #include <Graphy/Graph.hpp>
+#include <Graphy/Dual.hpp>
+#include <Graphy/Expression.hpp>
+#include <Graphy/Interval.hpp>
 #include <Graphy/Graphables.hpp>
@@ -0,0 +1,402 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_INTERVAL_H
+#define GRAPHY_INTERVAL_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Closed interval of real numbers for interval arithmetic
+	///
+	/// Arithmetic and the functions of <cmath> on intervals give
+	/// an interval containing every value the operation can take
+	/// for arguments within the intervals it is given. Results are
+	/// rounded outwards, so the bounds hold despite rounding error.
+	/// Evaluating a function on intervals of x and y bounds it over
+	/// the whole box, which ImplicitEquation uses to skip parts of
+	/// the canvas the curve cannot pass through.
+	///
+	/// Functions which are templated on their argument type can be
+	/// evaluated this way:
+	///
+	/// \code
+	/// struct Circle
+	/// {
+	///     template <typename T>
+	///     T operator()(const T& x, const T& y) const { return x*x + y*y - 1; }
+	/// };
+	/// graphy::Interval i = Circle()(graphy::Interval(2, 3), graphy::Interval(0, 1)); //i.lower > 0
+	/// \endcode
+	///
+	/// The functions must be called unqualified (exp rather than 
+	/// std::exp) so that the overloads for intervals are found.
+	/// Intervals cannot be compared, since the result of comparing
+	/// two overlapping intervals is not known. Each appearance of
+	/// a variable is treated as independent, so pow(x, 2) has 
+	/// tighter bounds than x*x.
+	///
+	/// Where a function is not defined or not finite for part of 
+	/// an interval, such as log(x) for an interval containing 0, 
+	/// nothing is known about the result and its bounds are NaN.
+	///
+	////////////////////////////////////////////////////////////
+	struct Interval
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Default constructor
+		///
+		/// Constructs the interval containing only 0.
+		///
+		////////////////////////////////////////////////////////////
+		Interval() :
+			lower(0), upper(0)
+		{
+
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Constructs the interval containing only \a value.
+		///
+		////////////////////////////////////////////////////////////
+		explicit Interval(double value) :
+			lower(value), upper(value)
+		{
+
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param lower Lowest value in the interval
+		/// \param upper Highest value in the interval
+		///
+		////////////////////////////////////////////////////////////
+		Interval(double lower, double upper) :
+			lower(lower), upper(upper)
+		{
+
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the interval about which nothing is known
+		///
+		////////////////////////////////////////////////////////////
+		static Interval unknown()
+		{
+			return Interval(std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN());
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the interval from \a lower to \a upper widened by the rounding error of a calculation
+		///
+		////////////////////////////////////////////////////////////
+		static Interval outward(double lower, double upper)
+		{
+			return Interval(std::nextafter(lower, -std::numeric_limits<double>::infinity()), std::nextafter(upper, std::numeric_limits<double>::infinity()));
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns false if nothing is known about the interval
+		///
+		////////////////////////////////////////////////////////////
+		bool known() const
+		{
+			return lower <= upper;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if \a value is in the interval
+		///
+		////////////////////////////////////////////////////////////
+		bool contains(double value) const
+		{
+			return lower <= value && value <= upper;
+		}
+
+		Interval& operator += (const Interval& rhs);
+		Interval& operator -= (const Interval& rhs);
+		Interval& operator *= (const Interval& rhs);
+		Interval& operator /= (const Interval& rhs);
+		Interval& operator += (double rhs);
+		Interval& operator -= (double rhs);
+		Interval& operator *= (double rhs);
+		Interval& operator /= (double rhs);
+
+		double lower; ///< Lowest value in the interval
+		double upper; ///< Highest value in the interval
+	};
+
+	////////////////////////////////////////////////////////////
+	// Arithmetic
+	////////////////////////////////////////////////////////////
+	inline Interval operator + (const Interval& a) { return a; }
+	inline Interval operator - (const Interval& a) { return Interval(-a.upper, -a.lower); }
+
+	inline Interval operator + (const Interval& a, const Interval& b) { return Interval::outward(a.lower + b.lower, a.upper + b.upper); }
+	inline Interval operator + (const Interval& a, double b) { return a + Interval(b); }
+	inline Interval operator + (double a, const Interval& b) { return Interval(a) + b; }
+
+	inline Interval operator - (const Interval& a, const Interval& b) { return Interval::outward(a.lower - b.upper, a.upper - b.lower); }
+	inline Interval operator - (const Interval& a, double b) { return a - Interval(b); }
+	inline Interval operator - (double a, const Interval& b) { return Interval(a) - b; }
+
+	inline Interval operator * (const Interval& a, const Interval& b)
+	{
+		double p[4] = { a.lower * b.lower, a.lower * b.upper, a.upper * b.lower, a.upper * b.upper };
+		if (std::isnan(p[0]) || std::isnan(p[1]) || std::isnan(p[2]) || std::isnan(p[3]))
+			return Interval::unknown();
+		return Interval::outward(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+	}
+	inline Interval operator * (const Interval& a, double b) { return a * Interval(b); }
+	inline Interval operator * (double a, const Interval& b) { return Interval(a) * b; }
+
+	inline Interval operator / (const Interval& a, const Interval& b)
+	{
+		//Values near 0 divide to values of any size
+		if (!b.known() || b.contains(0))
+			return Interval::unknown();
+		return a * Interval::outward(1 / b.upper, 1 / b.lower);
+	}
+	inline Interval operator / (const Interval& a, double b) { return a / Interval(b); }
+	inline Interval operator / (double a, const Interval& b) { return Interval(a) / b; }
+
+	inline Interval& Interval::operator += (const Interval& rhs) { return *this = *this + rhs; }
+	inline Interval& Interval::operator -= (const Interval& rhs) { return *this = *this - rhs; }
+	inline Interval& Interval::operator *= (const Interval& rhs) { return *this = *this * rhs; }
+	inline Interval& Interval::operator /= (const Interval& rhs) { return *this = *this / rhs; }
+	inline Interval& Interval::operator += (double rhs) { return *this = *this + rhs; }
+	inline Interval& Interval::operator -= (double rhs) { return *this = *this - rhs; }
+	inline Interval& Interval::operator *= (double rhs) { return *this = *this * rhs; }
+	inline Interval& Interval::operator /= (double rhs) { return *this = *this / rhs; }
+
+	////////////////////////////////////////////////////////////
+	// Functions
+	////////////////////////////////////////////////////////////
+	inline Interval abs(const Interval& a)
+	{
+		if (a.lower >= 0)
+			return a;
+		if (a.upper <= 0)
+			return -a;
+		if (!a.known())
+			return a;
+		return Interval(0, std::max(-a.lower, a.upper));
+	}
+
+	inline Interval fabs(const Interval& a)
+	{
+		return abs(a);
+	}
+
+	inline Interval sqrt(const Interval& a)
+	{
+		if (!(a.lower >= 0))
+			return Interval::unknown();
+		return Interval::outward(std::sqrt(a.lower), std::sqrt(a.upper));
+	}
+
+	inline Interval floor(const Interval& a) { return Interval(std::floor(a.lower), std::floor(a.upper)); }
+	inline Interval ceil(const Interval& a) { return Interval(std::ceil(a.lower), std::ceil(a.upper)); }
+	inline Interval trunc(const Interval& a) { return Interval(std::trunc(a.lower), std::trunc(a.upper)); }
+
+	inline Interval sin(const Interval& a)
+	{
+		const double pi = 3.14159265358979323846;
+		if (!a.known())
+			return a;
+		//Beyond this the periods cannot be counted accurately
+		if (a.upper - a.lower >= 2 * pi || std::abs(a.lower) > 1e9 || std::abs(a.upper) > 1e9)
+			return Interval(-1, 1);
+		double s[2] = { std::sin(a.lower), std::sin(a.upper) };
+		Interval r = Interval::outward(std::min(s[0], s[1]), std::max(s[0], s[1]));
+		//Include any peak or trough passed on the way
+		if (std::floor((a.upper - pi / 2) / (2 * pi)) != std::floor((a.lower - pi / 2) / (2 * pi)))
+			r.upper = 1;
+		if (std::floor((a.upper + pi / 2) / (2 * pi)) != std::floor((a.lower + pi / 2) / (2 * pi)))
+			r.lower = -1;
+		return Interval(std::max(r.lower, -1.0), std::min(r.upper, 1.0));
+	}
+
+	inline Interval cos(const Interval& a)
+	{
+		const double pi = 3.14159265358979323846;
+		if (!a.known())
+			return a;
+		if (a.upper - a.lower >= 2 * pi || std::abs(a.lower) > 1e9 || std::abs(a.upper) > 1e9)
+			return Interval(-1, 1);
+		double c[2] = { std::cos(a.lower), std::cos(a.upper) };
+		Interval r = Interval::outward(std::min(c[0], c[1]), std::max(c[0], c[1]));
+		if (std::floor(a.upper / (2 * pi)) != std::floor(a.lower / (2 * pi)))
+			r.upper = 1;
+		if (std::floor((a.upper - pi) / (2 * pi)) != std::floor((a.lower - pi) / (2 * pi)))
+			r.lower = -1;
+		return Interval(std::max(r.lower, -1.0), std::min(r.upper, 1.0));
+	}
+
+	inline Interval tan(const Interval& a)
+	{
+		const double pi = 3.14159265358979323846;
+		//Nothing is known across a pole
+		if (!a.known() || a.upper - a.lower >= pi || std::abs(a.lower) > 1e9 || std::abs(a.upper) > 1e9 ||
+			std::floor((a.upper - pi / 2) / pi) != std::floor((a.lower - pi / 2) / pi))
+			return Interval::unknown();
+		return Interval::outward(std::tan(a.lower), std::tan(a.upper));
+	}
+
+	inline Interval asin(const Interval& a)
+	{
+		if (!(a.lower >= -1 && a.upper <= 1))
+			return Interval::unknown();
+		return Interval::outward(std::asin(a.lower), std::asin(a.upper));
+	}
+
+	inline Interval acos(const Interval& a)
+	{
+		if (!(a.lower >= -1 && a.upper <= 1))
+			return Interval::unknown();
+		return Interval::outward(std::acos(a.upper), std::acos(a.lower));
+	}
+
+	inline Interval atan(const Interval& a) { return Interval::outward(std::atan(a.lower), std::atan(a.upper)); }
+	inline Interval sinh(const Interval& a) { return Interval::outward(std::sinh(a.lower), std::sinh(a.upper)); }
+	inline Interval tanh(const Interval& a) { return Interval::outward(std::tanh(a.lower), std::tanh(a.upper)); }
+	inline Interval exp(const Interval& a) { return Interval::outward(std::exp(a.lower), std::exp(a.upper)); }
+
+	inline Interval cosh(const Interval& a)
+	{
+		Interval m = abs(a);
+		return Interval::outward(std::cosh(m.lower), std::cosh(m.upper));
+	}
+
+	inline Interval log(const Interval& a)
+	{
+		if (!(a.lower > 0))
+			return Interval::unknown();
+		return Interval::outward(std::log(a.lower), std::log(a.upper));
+	}
+
+	inline Interval log10(const Interval& a)
+	{
+		if (!(a.lower > 0))
+			return Interval::unknown();
+		return Interval::outward(std::log10(a.lower), std::log10(a.upper));
+	}
+
+	inline Interval pow(const Interval& a, double b)
+	{
+		if (b == 0)
+			return Interval(1);
+		if (b < 0)
+			return 1 / pow(a, -b);
+		if (b != std::floor(b)) {
+			//Fractional powers are only defined for positive numbers
+			if (!(a.lower >= 0))
+				return Interval::unknown();
+			return Interval::outward(std::pow(a.lower, b), std::pow(a.upper, b));
+		}
+		if (std::fmod(b, 2) == 0) {
+			Interval m = abs(a);
+			return Interval::outward(std::pow(m.lower, b), std::pow(m.upper, b));
+		}
+		return Interval::outward(std::pow(a.lower, b), std::pow(a.upper, b));
+	}
+
+	inline Interval pow(double a, const Interval& b)
+	{
+		if (!(a > 0))
+			return Interval::unknown();
+		return exp(b * std::log(a));
+	}
+
+	inline Interval pow(const Interval& a, const Interval& b)
+	{
+		if (b.lower == b.upper)
+			return pow(a, b.lower);
+		return exp(b * log(a));
+	}
+
+	inline Interval atan2(const Interval& y, const Interval& x)
+	{
+		const double pi = 3.14159265358979323846;
+		if (!y.known() || !x.known())
+			return Interval::unknown();
+		//Boxes touching the negative x axis may take any angle
+		if (x.lower <= 0 && y.contains(0))
+			return Interval::outward(-pi, pi);
+		//Otherwise the angles of the box lie between those of its corners
+		double a[4] = { std::atan2(y.lower, x.lower), std::atan2(y.lower, x.upper), std::atan2(y.upper, x.lower), std::atan2(y.upper, x.upper) };
+		return Interval::outward(*std::min_element(a, a + 4), *std::max_element(a, a + 4));
+	}
+
+	inline Interval hypot(const Interval& a, const Interval& b)
+	{
+		Interval ma = abs(a), mb = abs(b);
+		if (!ma.known() || !mb.known())
+			return Interval::unknown();
+		return Interval::outward(std::hypot(ma.lower, mb.lower), std::hypot(ma.upper, mb.upper));
+	}
+
+	inline Interval fmod(const Interval& a, const Interval& b)
+	{
+		if (!a.known() || !b.known() || b.contains(0))
+			return Interval::unknown();
+		//Within one period the remainder increases with a
+		double m = std::max(std::abs(b.lower), std::abs(b.upper));
+		if (b.lower == b.upper && (a.lower >= 0 || a.upper <= 0) &&
+			std::trunc(a.lower / m) == std::trunc(a.upper / m) && std::abs(a.upper - a.lower) < m) {
+			Interval r = Interval::outward(std::fmod(a.lower, m), std::fmod(a.upper, m));
+			if (r.lower <= r.upper)
+				return r;
+		}
+		//Otherwise the remainder has the sign of a and is smaller than b
+		return Interval(a.lower >= 0 ? 0 : std::max(a.lower, -m), a.upper <= 0 ? 0 : std::min(a.upper, m));
+	}
+
+	inline Interval min(const Interval& a, const Interval& b)
+	{
+		if (!a.known() || !b.known())
+			return Interval::unknown();
+		return Interval(std::min(a.lower, b.lower), std::min(a.upper, b.upper));
+	}
+
+	inline Interval max(const Interval& a, const Interval& b)
+	{
+		if (!a.known() || !b.known())
+			return Interval::unknown();
+		return Interval(std::max(a.lower, b.lower), std::max(a.upper, b.upper));
+	}
+
+} // namespace graphy
+
+#endif //GRAPHY_INTERVAL_H
@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_RASTER_H
+#define GRAPHY_RASTER_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+namespace xsf
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Image held in memory and uploaded to a texture to be drawn
+	///
+	/// Pixels may be set from any thread, and from several 
+	/// threads at once if they set different pixels. The texture
+	/// is only touched by upload(), which must be called on the
+	/// thread which draws.
+	///
+	////////////////////////////////////////////////////////////
+	struct Raster
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructs an empty raster
+		///
+		////////////////////////////////////////////////////////////
+		Raster();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Changes the size of the raster
+		///
+		/// The contents of the pixels are undefined afterwards.
+		///
+		/// \param width Width in pixels
+		/// \param height Height in pixels
+		///
+		////////////////////////////////////////////////////////////
+		void resize(unsigned int width, unsigned int height);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the width of the raster in pixels
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int width() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the height of the raster in pixels
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int height() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sets the color of the pixel at (\a x, \a y)
+		///
+		////////////////////////////////////////////////////////////
+		void set(unsigned int x, unsigned int y, const sf::Color& color);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Copies the pixels to the texture and returns it
+		///
+		/// The texture is recreated only when the size of the raster
+		/// has changed. It must stay alive until anything drawn with
+		/// it has been displayed.
+		///
+		////////////////////////////////////////////////////////////
+		const sf::Texture& upload();
+
+		bool smooth; ///< If true the texture is interpolated bilinearly between pixels when drawn, otherwise each pixel is a solid square
+
+	private:
+		std::vector<sf::Uint8> pixels; ///< Red, green, blue and alpha of each pixel, a row at a time
+		unsigned int w, h; ///< Size of the raster
+		sf::Texture texture; ///< Texture the pixels were last uploaded to
+	};
+
+	inline void Raster::set(unsigned int x, unsigned int y, const sf::Color& color)
+	{
+		sf::Uint8* p = &pixels[(static_cast<std::size_t>(y) * w + x) * 4];
+		p[0] = color.r;
+		p[1] = color.g;
+		p[2] = color.b;
+		p[3] = color.a;
+	}
+
+} // namespace xsf
+
+#endif //GRAPHY_RASTER_H
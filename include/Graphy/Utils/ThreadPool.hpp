@@ -0,0 +1,131 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_THREADPOOL_H
+#define GRAPHY_THREADPOOL_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xsf
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Work-stealing pool of worker threads
+	///
+	////////////////////////////////////////////////////////////
+	class ThreadPool
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// Creates a pool which runs work on \a threads threads, 
+		/// including the thread waiting for the work to finish. A
+		/// pool of one thread runs all work on the calling thread.
+		///
+		/// \param threads Number of threads to use, or 0 to use one per hardware thread
+		///
+		////////////////////////////////////////////////////////////
+		explicit ThreadPool(unsigned int threads = 0);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destructor
+		///
+		/// Stops and joins all worker threads.
+		///
+		////////////////////////////////////////////////////////////
+		~ThreadPool();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Calls \a body for every index in [\a begin, \a end) in parallel
+		///
+		/// The range is split into chunks which are queued on the
+		/// workers, idle workers steal chunks from busy ones, and 
+		/// the calling thread runs queued work until every chunk has
+		/// finished. This may be called from inside \a body. If 
+		/// \a body throws, the first exception is rethrown once all
+		/// chunks have finished.
+		///
+		/// \param begin First index
+		/// \param end Index past the last index
+		/// \param body Function to call with each index
+		///
+		////////////////////////////////////////////////////////////
+		void parallel_for(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the number of threads work is run on
+		///
+		////////////////////////////////////////////////////////////
+		unsigned int size() const;
+
+	private:
+		struct Group
+		{
+			std::atomic<std::size_t> pending; ///< Number of tasks in the group which have not finished
+			std::mutex error_mutex;
+			std::exception_ptr error; ///< First exception thrown by a task in the group
+		};
+
+		struct Task
+		{
+			std::function<void()> work;
+			Group* group;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+
+		void push(const Task& task);
+		bool run_one(std::size_t home);
+		void work(std::size_t index);
+
+		std::vector<std::unique_ptr<Queue>> queues; ///< One queue per worker thread
+		std::vector<std::thread> workers;
+		std::atomic<std::size_t> queued; ///< Number of tasks waiting in the queues
+		std::atomic<std::size_t> next_queue; ///< Queue to push the next task from a non-worker thread to
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+		bool stopping;
+	};
+
+} // namespace xsf
+
+#endif //GRAPHY_THREADPOOL_H
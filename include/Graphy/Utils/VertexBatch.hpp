@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_VERTEXBATCH_H
+#define GRAPHY_VERTEXBATCH_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+namespace xsf
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Accumulates primitives into a single triangle list
+	/// so that they can be submitted to a render target in one
+	/// draw call
+	///
+	////////////////////////////////////////////////////////////
+	struct VertexBatch
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructs an empty batch
+		///
+		////////////////////////////////////////////////////////////
+		VertexBatch();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Adds an array of vertices to the batch
+		///
+		/// Triangles, triangle strips, triangle fans and quads are
+		/// converted to triangles and added to the batch. Any other
+		/// primitive type is drawn immediately after flushing the 
+		/// batch. The batch is also flushed first if \a target or 
+		/// the texture, shader or blend mode in \a states differ from
+		/// those of the vertices already in the batch.
+		///
+		/// \param target Render target the vertices are to be drawn to
+		/// \param vertices Pointer to the first vertex in an array of vertices
+		/// \param vertex_count Number of vertices in the array
+		/// \param type Primitive type to draw vertices
+		/// \param states Render states to draw vertices
+		///
+		////////////////////////////////////////////////////////////
+		void draw(sf::RenderTarget& target, const sf::Vertex* vertices, std::size_t vertex_count, sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Adds a drawable object to the batch
+		///
+		/// Vertex arrays and untextured shapes are tessellated and 
+		/// added to the batch. Any other drawable is drawn immediately
+		/// after flushing the batch.
+		///
+		/// \param target Render target the object is to be drawn to
+		/// \param drawable The object to be drawn
+		/// \param states Render states to draw object
+		///
+		////////////////////////////////////////////////////////////
+		void draw(sf::RenderTarget& target, const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Draws the batched vertices to their target and empties the batch
+		///
+		////////////////////////////////////////////////////////////
+		void flush();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the total number of vertices submitted to the batch
+		///
+		/// This counts vertices after conversion to triangles, 
+		/// including those drawn immediately, over the lifetime of
+		/// the batch.
+		///
+		////////////////////////////////////////////////////////////
+		std::size_t submitted() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the number of bytes allocated to hold batched vertices
+		///
+		////////////////////////////////////////////////////////////
+		std::size_t capacity() const;
+
+	private:
+		void bind(sf::RenderTarget& target, const sf::RenderStates& states);
+		void append(const sf::Vertex& vertex, const sf::Transform& transform);
+
+		sf::RenderTarget* target; ///< Target of the vertices in the batch
+		sf::RenderStates states; ///< Render states of the vertices in the batch
+		std::vector<sf::Vertex> vertices; ///< Batched vertices, forming a list of triangles
+		std::size_t flushed; ///< Number of vertices submitted which are no longer in the batch
+	};
+
+} // namespace xsf
+
+#endif //GRAPHY_VERTEXBATCH_H
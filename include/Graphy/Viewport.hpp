@@ -0,0 +1,171 @@
+/////////////////////////////////////////////////////////////////////////////////
+//MIT License
+//
+//Copyright(c) 2017 Dominic Price
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHY_VIEWPORT_H
+#define GRAPHY_VIEWPORT_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <Graphy/Utils/Vector2d.hpp>
+#include <Graphy/Utils/DoubleRect.hpp>
+
+namespace graphy
+{
+	////////////////////////////////////////////////////////////
+	/// \brief Snapshot of the transform between graph coordinates
+	/// and window coordinates
+	///
+	/// A graph takes a snapshot of its viewport at the start of
+	/// every update, so the mapping functions are a single
+	/// subtraction and multiplication which can be inlined. The 
+	/// array overloads convert many points at once with loops
+	/// simple enough for the compiler to vectorise.
+	///
+	////////////////////////////////////////////////////////////
+	class Viewport
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructs a viewport showing -1<x<1 and -1<y<1 in 1x1 pixels
+		///
+		////////////////////////////////////////////////////////////
+		Viewport();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Constructs a viewport showing \a bounds in a \a width by \a height window
+		///
+		/// \param bounds Region of the graph in graph coordinates, where top is the largest y-value
+		/// \param width Width of the window in pixels
+		/// \param height Height of the window in pixels
+		///
+		////////////////////////////////////////////////////////////
+		Viewport(const sf::DoubleRect& bounds, float width, float height);
+
+		float width() const; ///< Returns the width of the window in pixels
+		float height() const; ///< Returns the height of the window in pixels
+
+		sf::Vector2f map(double x, double y) const; ///< Maps a position in graph coordinates to a position in window coordinates
+		sf::Vector2f map(sf::Vector2d p) const; ///< Maps a position vector in graph coordinates to a position in window coordinates
+		float map_x(double x) const; ///< Maps an x-position in graph coordinates to a position in window coordinates
+		float map_y(double y) const; ///< Maps a y-position in graph coordinates to a position in window coordinates
+		sf::Vector2f rmap(double x, double y) const; ///< Maps a distance in graph coordinates to a distance in window coordinates
+		sf::Vector2f rmap(sf::Vector2d p) const; ///< Maps a distance vector in graph coordinates to a distance in window coordinates
+		float rmap_x(double x) const; ///< Maps an x-distance in graph coordinates to a distance in window coordinates
+		float rmap_y(double y) const; ///< Maps a y-distance in graph coordinates to a distance in window coordinates
+		sf::Vector2d amap(float x, float y) const; ///< Maps a position in window coordinates to a position in graph coordinates
+		sf::Vector2d amap(sf::Vector2f p) const; ///< Maps a position vector in window coordinates to a position in graph coordinates
+		double amap_x(float x) const; ///< Maps an x-position in window coordinates to a position in graph coordinates
+		double amap_y(float y) const; ///< Maps a y-position in window coordinates to a position in graph coordinates
+		sf::Vector2d armap(float x, float y) const; ///< Maps a distance in window coordinates to a distance in graph coordinates
+		sf::Vector2d armap(sf::Vector2f p) const; ///< Maps a distance vector in window coordinates to a distance in graph coordinates
+		double armap_x(float x) const; ///< Maps an x-distance in window coordinates to a distance in graph coordinates
+		double armap_y(float y) const; ///< Maps a y-distance in window coordinates to a distance in graph coordinates
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps arrays of positions in graph coordinates to the positions of vertices
+		///
+		/// Only the positions of the vertices are written.
+		///
+		/// \param x Array of \a count x-positions in graph coordinates
+		/// \param y Array of \a count y-positions in graph coordinates
+		/// \param count Number of positions to map
+		/// \param vertices Array of \a count vertices to receive the positions in window coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void map(const double* x, const double* y, std::size_t count, sf::Vertex* vertices) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps an array of x-positions in graph coordinates to window coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void map_x(const double* x, std::size_t count, float* result) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps an array of y-positions in graph coordinates to window coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void map_y(const double* y, std::size_t count, float* result) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps the positions of vertices to arrays of positions in graph coordinates
+		///
+		/// \param vertices Array of \a count vertices whose positions are in window coordinates
+		/// \param count Number of positions to map
+		/// \param x Array of \a count values to receive the x-positions in graph coordinates
+		/// \param y Array of \a count values to receive the y-positions in graph coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void amap(const sf::Vertex* vertices, std::size_t count, double* x, double* y) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps an array of x-positions in window coordinates to graph coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void amap_x(const float* x, std::size_t count, double* result) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Maps an array of y-positions in window coordinates to graph coordinates
+		///
+		////////////////////////////////////////////////////////////
+		void amap_y(const float* y, std::size_t count, double* result) const;
+
+	private:
+		double left; ///< Smallest x-value shown, at the left edge of the window
+		double top; ///< Largest y-value shown, at the top edge of the window
+		double scale_x, scale_y; ///< Pixels per graph unit along each axis
+		double inv_scale_x, inv_scale_y; ///< Graph units per pixel along each axis
+		float width_, height_; ///< Size of the window in pixels
+	};
+
+	inline float Viewport::width() const { return width_; }
+	inline float Viewport::height() const { return height_; }
+
+	//Absolute coordinates
+	inline sf::Vector2f Viewport::map(double x, double y) const { return sf::Vector2f(map_x(x), map_y(y)); }
+	inline sf::Vector2f Viewport::map(sf::Vector2d p) const { return map(p.x, p.y); }
+	inline float Viewport::map_x(double x) const { return static_cast<float>((x - left) * scale_x); }
+	inline float Viewport::map_y(double y) const { return static_cast<float>((top - y) * scale_y); }
+	//Relative coordinates
+	inline sf::Vector2f Viewport::rmap(double x, double y) const { return sf::Vector2f(rmap_x(x), rmap_y(y)); }
+	inline sf::Vector2f Viewport::rmap(sf::Vector2d p) const { return rmap(p.x, p.y); }
+	inline float Viewport::rmap_x(double x) const { return static_cast<float>(x * scale_x); }
+	inline float Viewport::rmap_y(double y) const { return static_cast<float>(y * scale_y); }
+
+	//Absolute coordinates
+	inline sf::Vector2d Viewport::amap(float x, float y) const { return sf::Vector2d(amap_x(x), amap_y(y)); }
+	inline sf::Vector2d Viewport::amap(sf::Vector2f p) const { return amap(p.x, p.y); }
+	inline double Viewport::amap_x(float x) const { return left + x * inv_scale_x; }
+	inline double Viewport::amap_y(float y) const { return top - y * inv_scale_y; }
+	//Relative coordinates
+	inline sf::Vector2d Viewport::armap(float x, float y) const { return sf::Vector2d(armap_x(x), armap_y(y)); }
+	inline sf::Vector2d Viewport::armap(sf::Vector2f p) const { return armap(p.x, p.y); }
+	inline double Viewport::armap_x(float x) const { return x * inv_scale_x; }
+	inline double Viewport::armap_y(float y) const { return y * inv_scale_y; }
+
+} // namespace graphy
+
+#endif //GRAPHY_VIEWPORT_H
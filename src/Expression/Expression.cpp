@@ -0,0 +1,756 @@
+#include <Graphy/Expression.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace graphy
+{
+
+	namespace
+	{
+		//Operations of the program
+		enum Op : unsigned char
+		{
+			Const, Var,
+			Add, Sub, Mul, Div, Pow, Neg,
+			Sqrt, Abs, Floor, Ceil,
+			Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh, Exp, Log, Log10,
+			Atan2, Min, Max, Hypot, Mod
+		};
+
+		struct Function
+		{
+			const char* name;
+			Op op;
+			int arity;
+		};
+
+		const Function functions[] = {
+			{ "sqrt", Sqrt, 1 }, { "abs", Abs, 1 }, { "floor", Floor, 1 }, { "ceil", Ceil, 1 },
+			{ "sin", Sin, 1 }, { "cos", Cos, 1 }, { "tan", Tan, 1 },
+			{ "asin", Asin, 1 }, { "acos", Acos, 1 }, { "atan", Atan, 1 },
+			{ "sinh", Sinh, 1 }, { "cosh", Cosh, 1 }, { "tanh", Tanh, 1 },
+			{ "exp", Exp, 1 }, { "log", Log, 1 }, { "ln", Log, 1 }, { "log10", Log10, 1 },
+			{ "atan2", Atan2, 2 }, { "pow", Pow, 2 }, { "min", Min, 2 }, { "max", Max, 2 },
+			{ "hypot", Hypot, 2 }, { "mod", Mod, 2 }
+		};
+
+		//Number of values each instruction works on at a time
+		const std::size_t block_size = 256;
+
+		//Min and max are left out since they return their first operand when
+		//either is NaN, so swapping them changes the result
+		bool commutative(unsigned char op)
+		{
+			return op == Add || op == Mul || op == Hypot;
+		}
+
+		//Functions which are not simple enough to write as a loop are called through a pointer
+		typedef double(*Unary)(double);
+		typedef double(*Binary)(double, double);
+
+		Unary unary(unsigned char op)
+		{
+			switch (op) {
+			case Sin: return [](double a) { return std::sin(a); };
+			case Cos: return [](double a) { return std::cos(a); };
+			case Tan: return [](double a) { return std::tan(a); };
+			case Asin: return [](double a) { return std::asin(a); };
+			case Acos: return [](double a) { return std::acos(a); };
+			case Atan: return [](double a) { return std::atan(a); };
+			case Sinh: return [](double a) { return std::sinh(a); };
+			case Cosh: return [](double a) { return std::cosh(a); };
+			case Tanh: return [](double a) { return std::tanh(a); };
+			case Exp: return [](double a) { return std::exp(a); };
+			case Log: return [](double a) { return std::log(a); };
+			case Log10: return [](double a) { return std::log10(a); };
+			default: return nullptr;
+			}
+		}
+
+		Binary binary(unsigned char op)
+		{
+			switch (op) {
+			case Pow: return [](double a, double b) { return std::pow(a, b); };
+			case Atan2: return [](double a, double b) { return std::atan2(a, b); };
+			case Hypot: return [](double a, double b) { return std::hypot(a, b); };
+			case Mod: return [](double a, double b) { return std::fmod(a, b); };
+			default: return nullptr;
+			}
+		}
+
+		//Applies an operation to arrays of n values, writing to d
+		void apply(unsigned char op, const double* a, const double* b, double* d, std::size_t n)
+		{
+			switch (op) {
+			case Add:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = a[i] + b[i];
+				break;
+			case Sub:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = a[i] - b[i];
+				break;
+			case Mul:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = a[i] * b[i];
+				break;
+			case Div:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = a[i] / b[i];
+				break;
+			case Neg:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = -a[i];
+				break;
+			case Sqrt:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = std::sqrt(a[i]);
+				break;
+			case Abs:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = std::abs(a[i]);
+				break;
+			case Floor:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = std::floor(a[i]);
+				break;
+			case Ceil:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = std::ceil(a[i]);
+				break;
+			case Min:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = b[i] < a[i] ? b[i] : a[i];
+				break;
+			case Max:
+				for (std::size_t i = 0; i < n; ++i)
+					d[i] = a[i] < b[i] ? b[i] : a[i];
+				break;
+			default:
+				if (Unary f = unary(op)) {
+					for (std::size_t i = 0; i < n; ++i)
+						d[i] = f(a[i]);
+				}
+				else if (Binary f = binary(op)) {
+					for (std::size_t i = 0; i < n; ++i)
+						d[i] = f(a[i], b[i]);
+				}
+				break;
+			}
+		}
+
+		//Applies an operation to single values
+		double apply(unsigned char op, double a, double b)
+		{
+			double d;
+			apply(op, &a, &b, &d, 1);
+			return d;
+		}
+	}
+
+	namespace
+	{
+		//Applies an operation to dual numbers
+		template <typename T>
+		Dual<T> apply(unsigned char op, const Dual<T>& a, const Dual<T>& b)
+		{
+			switch (op) {
+			case Add: return a + b;
+			case Sub: return a - b;
+			case Mul: return a * b;
+			case Div: return a / b;
+			case Pow: return pow(a, b);
+			case Neg: return -a;
+			case Sqrt: return sqrt(a);
+			case Abs: return abs(a);
+			case Floor: return floor(a);
+			case Ceil: return ceil(a);
+			case Sin: return sin(a);
+			case Cos: return cos(a);
+			case Tan: return tan(a);
+			case Asin: return asin(a);
+			case Acos: return acos(a);
+			case Atan: return atan(a);
+			case Sinh: return sinh(a);
+			case Cosh: return cosh(a);
+			case Tanh: return tanh(a);
+			case Exp: return exp(a);
+			case Log: return log(a);
+			case Log10: return log10(a);
+			case Atan2: return atan2(a, b);
+			case Min: return min(a, b);
+			case Max: return max(a, b);
+			case Hypot: return hypot(a, b);
+			case Mod: return fmod(a, b);
+			default: return Dual<T>(std::numeric_limits<double>::quiet_NaN());
+			}
+		}
+
+		//Applies an operation to intervals
+		Interval apply(unsigned char op, const Interval& a, const Interval& b)
+		{
+			switch (op) {
+			case Add: return a + b;
+			case Sub: return a - b;
+			case Mul: return a * b;
+			case Div: return a / b;
+			case Pow: return pow(a, b);
+			case Neg: return -a;
+			case Sqrt: return sqrt(a);
+			case Abs: return abs(a);
+			case Floor: return floor(a);
+			case Ceil: return ceil(a);
+			case Sin: return sin(a);
+			case Cos: return cos(a);
+			case Tan: return tan(a);
+			case Asin: return asin(a);
+			case Acos: return acos(a);
+			case Atan: return atan(a);
+			case Sinh: return sinh(a);
+			case Cosh: return cosh(a);
+			case Tanh: return tanh(a);
+			case Exp: return exp(a);
+			case Log: return log(a);
+			case Log10: return log10(a);
+			case Atan2: return atan2(a, b);
+			case Min: return min(a, b);
+			case Max: return max(a, b);
+			case Hypot: return hypot(a, b);
+			case Mod: return fmod(a, b);
+			default: return Interval::unknown();
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////
+	// Recursive descent parser which builds the program as it
+	// goes, folding constants and sharing repeated subexpressions
+	////////////////////////////////////////////////////////////
+	class Expression::Parser
+	{
+	public:
+		Parser(const std::string& text, const std::vector<std::string>& names) :
+			text(text), names(names), pos(0)
+		{
+
+		}
+
+		int parse()
+		{
+			int root = sum();
+			skip();
+			if (pos < text.size())
+				fail("unexpected '" + std::string(1, text[pos]) + "'");
+			return root;
+		}
+
+		std::vector<Node> nodes;
+
+	private:
+		//sum = product { ("+" | "-") product }
+		int sum()
+		{
+			int a = product();
+			while (true) {
+				if (accept('+'))
+					a = make(Add, a, product());
+				else if (accept('-'))
+					a = make(Sub, a, product());
+				else
+					return a;
+			}
+		}
+
+		//product = negation { ("*" | "/") negation }
+		int product()
+		{
+			int a = negation();
+			while (true) {
+				if (accept('*'))
+					a = make(Mul, a, negation());
+				else if (accept('/'))
+					a = make(Div, a, negation());
+				else
+					return a;
+			}
+		}
+
+		//negation = ("-" | "+") negation | power
+		int negation()
+		{
+			if (accept('-'))
+				return make(Neg, negation());
+			if (accept('+'))
+				return negation();
+			return power();
+		}
+
+		//power = primary [ "^" negation ], so that -x^2 = -(x^2) and x^-1 is allowed
+		int power()
+		{
+			int a = primary();
+			if (accept('^'))
+				return make(Pow, a, negation());
+			return a;
+		}
+
+		//primary = number | name | name "(" sum { "," sum } ")" | "(" sum ")"
+		int primary()
+		{
+			skip();
+			if (pos >= text.size())
+				fail("unexpected end of expression");
+
+			if (accept('(')) {
+				int a = sum();
+				expect(')');
+				return a;
+			}
+
+			char c = text[pos];
+			if (std::isdigit(c, std::locale::classic()) || c == '.')
+				return number();
+			if (!std::isalpha(c, std::locale::classic()) && c != '_')
+				fail("unexpected '" + std::string(1, c) + "'");
+
+			std::size_t start = pos;
+			while (pos < text.size() && (std::isalnum(text[pos], std::locale::classic()) || text[pos] == '_'))
+				++pos;
+			std::string name = text.substr(start, pos - start);
+
+			if (accept('(')) {
+				for (const Function& f : functions) {
+					if (name != f.name)
+						continue;
+					int a = sum(), b = -1;
+					if (f.arity == 2) {
+						expect(',');
+						b = sum();
+					}
+					expect(')');
+					return make(f.op, a, b);
+				}
+				pos = start;
+				fail("unknown function '" + name + "'");
+			}
+			for (std::size_t i = 0; i < names.size(); ++i) {
+				if (name == names[i])
+					return make(Var, static_cast<int>(i));
+			}
+			if (name == "pi")
+				return constant(3.14159265358979323846);
+			if (name == "e")
+				return constant(2.71828182845904523536);
+			pos = start;
+			fail("unknown variable '" + name + "'");
+		}
+
+		int number()
+		{
+			//Parse independently of the global locale's decimal point
+			std::istringstream s(text.substr(pos));
+			s.imbue(std::locale::classic());
+			double value;
+			if (!(s >> value))
+				fail("invalid number");
+			pos = s.eof() ? text.size() : pos + static_cast<std::size_t>(s.tellg());
+			return constant(value);
+		}
+
+		int constant(double value)
+		{
+			return make(Const, -1, -1, value);
+		}
+
+		bool is_constant(int a, double value) const
+		{
+			return a >= 0 && nodes[a].op == Const && nodes[a].value == value;
+		}
+
+		//Adds an operation to the program, simplifying it where possible
+		int make(unsigned char op, int a = -1, int b = -1, double value = 0)
+		{
+			//Fold operations on constants
+			if (op != Const && op != Var && nodes[a].op == Const && (b < 0 || nodes[b].op == Const))
+				return constant(apply(op, nodes[a].value, b < 0 ? 0 : nodes[b].value));
+
+			switch (op) {
+			case Add:
+				if (is_constant(a, 0))
+					return b;
+				if (is_constant(b, 0))
+					return a;
+				break;
+			case Sub:
+				if (is_constant(b, 0))
+					return a;
+				if (is_constant(a, 0))
+					return make(Neg, b);
+				break;
+			case Mul:
+				if (is_constant(a, 1))
+					return b;
+				if (is_constant(b, 1))
+					return a;
+				if (is_constant(a, -1))
+					return make(Neg, b);
+				if (is_constant(b, -1))
+					return make(Neg, a);
+				break;
+			case Div:
+				if (is_constant(b, 1))
+					return a;
+				if (nodes[b].op == Const)
+					return make(Mul, a, constant(1 / nodes[b].value));
+				break;
+			case Pow:
+				if (nodes[b].op != Const)
+					break;
+				if (nodes[b].value == 0)
+					return constant(1);
+				if (nodes[b].value == 1)
+					return a;
+				if (nodes[b].value == 2)
+					return make(Mul, a, a);
+				if (nodes[b].value == 3)
+					return make(Mul, make(Mul, a, a), a);
+				if (nodes[b].value == 4)
+					return make(Mul, make(Mul, a, a), make(Mul, a, a));
+				if (nodes[b].value == 0.5)
+					return make(Sqrt, a);
+				if (nodes[b].value == -1)
+					return make(Div, constant(1), a);
+				break;
+			case Neg:
+				if (nodes[a].op == Neg)
+					return nodes[a].a;
+				break;
+			default:
+				break;
+			}
+
+			//Order the operands of commutative operations so that equal
+			//subexpressions are recognised
+			if (commutative(op) && a > b)
+				std::swap(a, b);
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			Key key(op, a, b, bits);
+			auto it = known.find(key);
+			if (it != known.end())
+				return it->second;
+
+			Node node = { op, a, b, value };
+			nodes.push_back(node);
+			int index = static_cast<int>(nodes.size() - 1);
+			known[key] = index;
+			return index;
+		}
+
+		void skip()
+		{
+			while (pos < text.size() && std::isspace(text[pos], std::locale::classic()))
+				++pos;
+		}
+
+		bool accept(char c)
+		{
+			skip();
+			if (pos < text.size() && text[pos] == c) {
+				++pos;
+				return true;
+			}
+			return false;
+		}
+
+		void expect(char c)
+		{
+			if (!accept(c))
+				fail(std::string("expected '") + c + "'");
+		}
+
+		[[noreturn]] void fail(const std::string& what)
+		{
+			std::stringstream s;
+			s << what << " at position " << pos + 1;
+			throw std::invalid_argument(s.str());
+		}
+
+		typedef std::tuple<unsigned char, int, int, std::uint64_t> Key;
+		std::map<Key, int> known; ///< Index of every distinct operation
+		const std::string& text;
+		const std::vector<std::string>& names;
+		std::size_t pos;
+	};
+
+	Expression::Expression(const std::string& text, const std::vector<std::string>& variables) :
+		source(text), names(variables)
+	{
+		Parser parser(text, variables);
+		int root;
+		try {
+			root = parser.parse();
+		}
+		catch (const std::invalid_argument& e) {
+			message = e.what();
+			std::cerr << "Unable to compile expression \"" << text << "\": " << message << ".\n";
+			return;
+		}
+
+		//Keep only the operations the result depends on, which are already
+		//in an order where operands come before their uses
+		std::vector<int> index(parser.nodes.size(), -1);
+		std::vector<int> stack(1, root);
+		while (!stack.empty()) {
+			int i = stack.back();
+			stack.pop_back();
+			if (index[i] >= 0)
+				continue;
+			index[i] = 0;
+			const Node& node = parser.nodes[i];
+			if (node.op != Const && node.op != Var) {
+				stack.push_back(node.a);
+				if (node.b >= 0)
+					stack.push_back(node.b);
+			}
+		}
+		for (std::size_t i = 0; i < parser.nodes.size(); ++i) {
+			if (index[i] < 0)
+				continue;
+			Node node = parser.nodes[i];
+			if (node.op != Const && node.op != Var) {
+				node.a = index[node.a];
+				if (node.b >= 0)
+					node.b = index[node.b];
+			}
+			index[i] = static_cast<int>(program.size());
+			program.push_back(node);
+		}
+	}
+
+	bool Expression::valid() const
+	{
+		return !program.empty();
+	}
+
+	const std::string& Expression::error() const
+	{
+		return message;
+	}
+
+	const std::string& Expression::text() const
+	{
+		return source;
+	}
+
+	double Expression::operator()(double x) const
+	{
+		double result;
+		evaluate(&x, &result, 1);
+		return result;
+	}
+
+	double Expression::operator()(double x, double y) const
+	{
+		double result;
+		evaluate(&x, &y, &result, 1);
+		return result;
+	}
+
+	template <typename T>
+	Dual<T> Expression::operator()(const Dual<T>& x) const
+	{
+		if (program.empty())
+			return Dual<T>(std::numeric_limits<double>::quiet_NaN());
+
+		thread_local std::vector<Dual<T>> values;
+		values.resize(program.size());
+		for (std::size_t i = 0; i < program.size(); ++i) {
+			const Node& node = program[i];
+			if (node.op == Const)
+				values[i] = Dual<T>(node.value);
+			else if (node.op == Var)
+				values[i] = node.a == 0 ? x : Dual<T>();
+			else if (node.op == Pow && program[node.b].op == Const)
+				//Constant powers of negative numbers have derivatives even though logarithms do not
+				values[i] = pow(values[node.a], program[node.b].value);
+			else
+				values[i] = apply(node.op, values[node.a], node.b < 0 ? Dual<T>() : values[node.b]);
+		}
+		return values.back();
+	}
+
+	template Dual<NestedDual<0>::Type> Expression::operator()(const Dual<NestedDual<0>::Type>&) const;
+	template Dual<NestedDual<1>::Type> Expression::operator()(const Dual<NestedDual<1>::Type>&) const;
+	template Dual<NestedDual<2>::Type> Expression::operator()(const Dual<NestedDual<2>::Type>&) const;
+	template Dual<NestedDual<3>::Type> Expression::operator()(const Dual<NestedDual<3>::Type>&) const;
+
+	Interval Expression::operator()(const Interval& x, const Interval& y) const
+	{
+		if (program.empty())
+			return Interval::unknown();
+
+		thread_local std::vector<Interval> values;
+		values.resize(program.size());
+		for (std::size_t i = 0; i < program.size(); ++i) {
+			const Node& node = program[i];
+			if (node.op == Const)
+				values[i] = Interval(node.value);
+			else if (node.op == Var)
+				values[i] = node.a == 0 ? x : node.a == 1 ? y : Interval();
+			else if (node.op == Pow && program[node.b].op == Const)
+				//Constant powers of negative numbers are defined even though logarithms are not
+				values[i] = pow(values[node.a], program[node.b].value);
+			else if (node.op == Mul && node.a == node.b)
+				//Squares are never negative, which multiplying the bounds would not know
+				values[i] = pow(values[node.a], 2);
+			else
+				values[i] = apply(node.op, values[node.a], node.b < 0 ? Interval() : values[node.b]);
+		}
+		return values.back();
+	}
+
+	bool Expression::derivatives(double x, double* result, unsigned int n) const
+	{
+		return differentiate(*this, x, result, n);
+	}
+
+	void Expression::evaluate(const double* x, double* result, std::size_t count) const
+	{
+		thread_local std::vector<Input> inputs;
+		inputs.assign(names.size(), Input{ nullptr, 0 });
+		if (!inputs.empty())
+			inputs[0].array = x;
+		run(inputs.data(), result, count);
+	}
+
+	void Expression::evaluate(const double* x, double y, double* result, std::size_t count) const
+	{
+		thread_local std::vector<Input> inputs;
+		inputs.assign(std::max<std::size_t>(names.size(), 2), Input{ nullptr, 0 });
+		inputs[0].array = x;
+		inputs[1].value = y;
+		run(inputs.data(), result, count);
+	}
+
+	void Expression::evaluate(const double* x, const double* y, double* result, std::size_t count) const
+	{
+		thread_local std::vector<Input> inputs;
+		inputs.assign(std::max<std::size_t>(names.size(), 2), Input{ nullptr, 0 });
+		inputs[0].array = x;
+		inputs[1].array = y;
+		run(inputs.data(), result, count);
+	}
+
+	void Expression::run(const Input* inputs, double* result, std::size_t count) const
+	{
+		if (program.empty()) {
+			std::fill(result, result + count, std::numeric_limits<double>::quiet_NaN());
+			return;
+		}
+
+		//Working memory is reused between calls on the same thread
+		thread_local std::vector<unsigned char> uniform;
+		thread_local std::vector<int> slot, last_use, free_slots;
+		thread_local std::vector<double> scratch;
+		std::size_t n = program.size();
+		uniform.assign(n, 0);
+		slot.assign(n, -1);
+		last_use.assign(n, 0);
+		free_slots.clear();
+
+		//Operations which only depend on constants and single values are
+		//calculated once for the whole call
+		for (std::size_t i = 0; i < n; ++i) {
+			const Node& node = program[i];
+			if (node.op == Const)
+				uniform[i] = 1;
+			else if (node.op == Var)
+				uniform[i] = !inputs[node.a].array;
+			else {
+				uniform[i] = uniform[node.a] && (node.b < 0 || uniform[node.b]);
+				last_use[node.a] = static_cast<int>(i);
+				if (node.b >= 0)
+					last_use[node.b] = static_cast<int>(i);
+			}
+		}
+
+		//Give every value a block of working memory, reusing blocks once
+		//their value is no longer needed. Arrays of inputs are read in place.
+		int slots = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			const Node& node = program[i];
+			if (uniform[i]) {
+				slot[i] = slots++;
+				continue;
+			}
+			if (node.op == Var)
+				continue;
+			for (int operand : { node.a, node.b }) {
+				if (operand >= 0 && last_use[operand] == static_cast<int>(i) && !uniform[operand] && slot[operand] >= 0) {
+					free_slots.push_back(slot[operand]);
+					slot[operand] = -1 - slot[operand];
+				}
+			}
+			if (free_slots.empty())
+				slot[i] = slots++;
+			else {
+				slot[i] = free_slots.back();
+				free_slots.pop_back();
+			}
+		}
+		//Slots of freed values were stored as -1 - slot so they can still be read
+		//by the operation which frees them
+		auto block = [](int s) { return static_cast<std::size_t>(s < 0 ? -1 - s : s) * block_size; };
+		scratch.resize(static_cast<std::size_t>(slots) * block_size);
+
+		for (std::size_t i = 0; i < n; ++i) {
+			if (!uniform[i])
+				continue;
+			const Node& node = program[i];
+			double value;
+			if (node.op == Const)
+				value = node.value;
+			else if (node.op == Var)
+				value = inputs[node.a].value;
+			else
+				value = apply(node.op, scratch[block(slot[node.a])], node.b < 0 ? 0 : scratch[block(slot[node.b])]);
+			std::fill(scratch.begin() + block(slot[i]), scratch.begin() + block(slot[i]) + block_size, value);
+		}
+		if (uniform[n - 1]) {
+			std::fill(result, result + count, scratch[block(slot[n - 1])]);
+			return;
+		}
+
+		//Run the remaining operations a block at a time
+		for (std::size_t start = 0; start < count; start += block_size) {
+			std::size_t m = std::min(block_size, count - start);
+			auto read = [&](int operand) -> const double* {
+				if (operand < 0)
+					return nullptr;
+				if (!uniform[operand] && program[operand].op == Var)
+					return inputs[program[operand].a].array + start;
+				return &scratch[block(slot[operand])];
+			};
+			for (std::size_t i = 0; i < n; ++i) {
+				const Node& node = program[i];
+				if (uniform[i] || node.op == Var)
+					continue;
+				double* d = i == n - 1 ? result + start : &scratch[block(slot[i])];
+				apply(node.op, read(node.a), read(node.b), d, m);
+			}
+			if (program[n - 1].op == Var)
+				std::copy(read(static_cast<int>(n - 1)), read(static_cast<int>(n - 1)) + m, result + start);
+		}
+	}
+
+}
@@ -9,10 +9,13 @@ namespace graphy
 	float Graph::status_bar_height = 20;
 
 	Graph::Graph(const std::string& title, bool fullscreen, unsigned int width, unsigned int height) :
-		zoom_speed(1.5f), scroll_speed(250),
+		zoom_speed(1.5f), scroll_speed(250), headless(false),
 		sbar(window, status_bar_height, font),
 		bg_color(sf::Color::White), default_filename(title), print_counter(0),
-		bounds(-1, 1, 2, 2)
+		bounds(-1, 1, 2, 2),
+		damage_tracking(false), damaged_layers(all_layers), redraw_mask(0),
+		on_demand(false), animating(false), update_requested(false),
+		threads(0), frame_stats(), drawing_stats(nullptr), framerate_frames(0)
 	{
 		//Set size of window
 		if (fullscreen)
@@ -29,10 +32,24 @@ namespace graphy
 		window.setVerticalSyncEnabled(true);
 
 		//Make canvas
-		for (sf::RenderTexture& layer : layers) {
-			layer.create(width, height);
-			layer.setSmooth(true);
-		}
+		create_layers(this->width(true), this->height(true));
+	}
+
+	Graph::Graph(unsigned int width, unsigned int height) :
+		zoom_speed(1.5f), scroll_speed(250), headless(true),
+		sbar(window, status_bar_height, font),
+		bg_color(sf::Color::White), default_filename("Graphy"), print_counter(0),
+		bounds(-1, 1, 2, 2),
+		damage_tracking(false), damaged_layers(all_layers), redraw_mask(0),
+		on_demand(false), animating(false), update_requested(false),
+		threads(0), frame_stats(), drawing_stats(nullptr), framerate_frames(0)
+	{
+		//Load font
+		if (!font.loadFromFile("arial.ttf"))
+			std::cerr << "Could not load font";
+
+		//Make canvas
+		create_layers(width, height);
 	}
 
 	Graph::~Graph()
@@ -40,4 +57,13 @@ namespace graphy
 		window.close();
 	}
 
+	void Graph::create_layers(unsigned int width, unsigned int height)
+	{
+		for (sf::RenderTexture& layer : layers) {
+			layer.create(width, height);
+			layer.setSmooth(true);
+		}
+		damaged_layers = all_layers;
+	}
+
 }
@@ -8,6 +8,10 @@ namespace graphy
 	{
 		graphables.push_back(&g);
 		g.graph = this;
+		g.view = viewport();
+		//Which layers the graphable draws to is not known yet
+		g.dirty = true;
+		g.layer_mask = all_layers;
 	}
 
 	void Graph::remove(Graphable& g)
@@ -15,6 +19,7 @@ namespace graphy
 		auto it = graphables.begin(), end = graphables.end();
 		while (it != end) {
 			if (*it == &g) {
+				damaged_layers |= g.layer_mask;
 				graphables.erase(it);
 				g.graph = nullptr;
 				break;
@@ -28,6 +33,7 @@ namespace graphy
 		for (Graphable* g : graphables)
 			g->graph = nullptr;
 		graphables.clear();
+		damaged_layers = all_layers;
 	}
 
 }
@@ -1,4 +1,5 @@
 #include <Graphy/Graph.hpp>
+#include <Graphy/Graphable.hpp>
 #include <iostream>
 
 namespace graphy
@@ -9,6 +10,48 @@ namespace graphy
 		if (!font.loadFromFile(filename.c_str()))
 			std::cerr << "Unable to load font " << filename <<
 			". Default used.\n";
+		invalidate();
+	}
+
+	void Graph::invalidate()
+	{
+		for (Graphable* graphable : graphables)
+			graphable->invalidate();
+		damaged_layers = all_layers;
+		update_requested = true;
+	}
+
+	void Graph::set_damage_tracking(bool enabled)
+	{
+		damage_tracking = enabled;
+	}
+
+	void Graph::set_on_demand(bool enabled)
+	{
+		on_demand = enabled;
+	}
+
+	void Graph::set_animating(bool animating)
+	{
+		this->animating = animating;
+	}
+
+	void Graph::request_update()
+	{
+		update_requested = true;
+	}
+
+	void Graph::set_threads(unsigned int count)
+	{
+		threads = count;
+		pool.reset();
+	}
+
+	xsf::ThreadPool& Graph::workers()
+	{
+		if (!pool)
+			pool.reset(new xsf::ThreadPool(threads));
+		return *pool;
 	}
 
 
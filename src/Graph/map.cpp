@@ -3,84 +3,35 @@
 namespace graphy
 {
 
-	sf::Vector2f Graph::map(double x, double y)
-	{
-		return{ map_x(x), map_y(y) };
-	}
-
-	sf::Vector2f Graph::map(sf::Vector2d p)
-	{
-		return map(p.x, p.y);
-	}
-
-	float Graph::map_x(double x) {
-		return rmap_x(x - bounds.left);
-	}
-
-	float Graph::map_y(double y) {
-		return height() - rmap_y(y - bounds.top + bounds.height);
-	}
-
-	sf::Vector2<double> Graph::amap(float x, float y)
-	{
-		return{ amap_x(x), amap_y(y) };
-	}
-
-	sf::Vector2d Graph::amap(sf::Vector2f p)
-	{
-		return amap(p.x, p.y);
-	}
-
-	double Graph::amap_x(float x)
-	{
-		return armap_x(x) + bounds.left;
-	}
-
-	double Graph::amap_y(float y)
-	{
-		return bounds.top - bounds.height + armap_y(height() - y);
-	}
-
-
-	sf::Vector2f Graph::rmap(double x, double y)
-	{
-		return sf::Vector2f(rmap_x(x), rmap_y(y));
-	}
-
-	sf::Vector2f Graph::rmap(sf::Vector2d p)
-	{
-		return rmap(p.x, p.y);
-	}
-
-	float Graph::rmap_x(double x)
-	{
-		return static_cast<float>(x * width() / (bounds.width));
-	}
-
-	float Graph::rmap_y(double y)
-	{
-		return static_cast<float>(y * height() / (bounds.height));
-	}
-
-
-	sf::Vector2d Graph::armap(float x, float y)
-	{
-		return sf::Vector2d(armap_x(x), armap_y(y));
-	}
-
-	sf::Vector2d Graph::armap(sf::Vector2f p)
-	{
-		return armap(p.x, p.y);
-	}
-
-	double Graph::armap_x(float x)
-	{
-		return x * (bounds.width) / width();
-	}
-
-	double Graph::armap_y(float y)
-	{
-		return y * (bounds.height) / height();
-	}
+	Viewport Graph::viewport()
+	{
+		return Viewport(bounds, width(), height());
+	}
+
+	//Convert from graph coordinates to window coordinates
+
+	//Absolute coordinates
+	sf::Vector2f Graph::map(double x, double y) { return viewport().map(x, y); }
+	sf::Vector2f Graph::map(sf::Vector2d p) { return viewport().map(p); }
+	float Graph::map_x(double x) { return viewport().map_x(x); }
+	float Graph::map_y(double y) { return viewport().map_y(y); }
+	//Relative coordinates
+	sf::Vector2f Graph::rmap(double x, double y) { return viewport().rmap(x, y); }
+	sf::Vector2f Graph::rmap(sf::Vector2d p) { return viewport().rmap(p); }
+	float Graph::rmap_x(double x) { return viewport().rmap_x(x); }
+	float Graph::rmap_y(double y) { return viewport().rmap_y(y); }
+
+	//Convert from window coordinates to graph coordinates
+
+	//Absolute coordinates
+	sf::Vector2d Graph::amap(float x, float y) { return viewport().amap(x, y); }
+	sf::Vector2d Graph::amap(sf::Vector2f p) { return viewport().amap(p); }
+	double Graph::amap_x(float x) { return viewport().amap_x(x); }
+	double Graph::amap_y(float y) { return viewport().amap_y(y); }
+	//Relative coordinates
+	sf::Vector2d Graph::armap(float x, float y) { return viewport().armap(x, y); }
+	sf::Vector2d Graph::armap(sf::Vector2f p) { return viewport().armap(p); }
+	double Graph::armap_x(float x) { return viewport().armap_x(x); }
+	double Graph::armap_y(float y) { return viewport().armap_y(y); }
 
 }
@@ -0,0 +1,70 @@
+#include <Graphy/Viewport.hpp>
+
+namespace graphy
+{
+
+	Viewport::Viewport() :
+		Viewport(sf::DoubleRect(-1, 1, 2, 2), 1, 1)
+	{
+
+	}
+
+	Viewport::Viewport(const sf::DoubleRect& bounds, float width, float height) :
+		left(bounds.left), top(bounds.top),
+		scale_x(width / bounds.width), scale_y(height / bounds.height),
+		inv_scale_x(bounds.width / width), inv_scale_y(bounds.height / height),
+		width_(width), height_(height)
+	{
+
+	}
+
+	//The loops below copy the members into locals so that the compiler
+	//knows they cannot alias the output arrays
+
+	void Viewport::map(const double* x, const double* y, std::size_t count, sf::Vertex* vertices) const
+	{
+		const double l = left, t = top, sx = scale_x, sy = scale_y;
+		for (std::size_t i = 0; i < count; ++i) {
+			vertices[i].position.x = static_cast<float>((x[i] - l) * sx);
+			vertices[i].position.y = static_cast<float>((t - y[i]) * sy);
+		}
+	}
+
+	void Viewport::map_x(const double* x, std::size_t count, float* result) const
+	{
+		const double l = left, sx = scale_x;
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = static_cast<float>((x[i] - l) * sx);
+	}
+
+	void Viewport::map_y(const double* y, std::size_t count, float* result) const
+	{
+		const double t = top, sy = scale_y;
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = static_cast<float>((t - y[i]) * sy);
+	}
+
+	void Viewport::amap(const sf::Vertex* vertices, std::size_t count, double* x, double* y) const
+	{
+		const double l = left, t = top, isx = inv_scale_x, isy = inv_scale_y;
+		for (std::size_t i = 0; i < count; ++i) {
+			x[i] = l + vertices[i].position.x * isx;
+			y[i] = t - vertices[i].position.y * isy;
+		}
+	}
+
+	void Viewport::amap_x(const float* x, std::size_t count, double* result) const
+	{
+		const double l = left, isx = inv_scale_x;
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = l + x[i] * isx;
+	}
+
+	void Viewport::amap_y(const float* y, std::size_t count, double* result) const
+	{
+		const double t = top, isy = inv_scale_y;
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = t - y[i] * isy;
+	}
+
+}
@@ -5,37 +5,128 @@
 #include <iomanip>
 #include <prog_info.h>
 #include <ctime>
+#include <iostream>
 
 namespace graphy
 {
 
+	namespace
+	{
+		//Time between checks for events when the mainloop is idle
+		const sf::Time idle_interval = sf::milliseconds(10);
+
+		bool navigation_key_pressed()
+		{
+			return sf::Keyboard::isKeyPressed(sf::Keyboard::Up) ||
+				sf::Keyboard::isKeyPressed(sf::Keyboard::Down) ||
+				sf::Keyboard::isKeyPressed(sf::Keyboard::Left) ||
+				sf::Keyboard::isKeyPressed(sf::Keyboard::Right) ||
+				sf::Keyboard::isKeyPressed(sf::Keyboard::LBracket) ||
+				sf::Keyboard::isKeyPressed(sf::Keyboard::RBracket);
+		}
+	}
+
 	void Graph::update()
 	{
-		static sf::Clock clock;
-		static float framerate = 0;
-		static unsigned int frames = 0;
-		if (clock.getElapsedTime().asSeconds() > 1) {
-			framerate = frames / clock.restart().asSeconds();
-			frames = 0;
+		sf::Clock frame_clock, phase_clock;
+		if (framerate_clock.getElapsedTime().asSeconds() > 1) {
+			frame_stats.framerate = framerate_frames / framerate_clock.restart().asSeconds();
+			framerate_frames = 0;
 		}
-		++frames;
+		++framerate_frames;
 
-		//Clear
-		for (sf::RenderTexture& layer : layers)
-			layer.clear(sf::Color::Transparent);
-		window.clear(bg_color);
+		//Find the layers which need redrawing
+		if (!damage_tracking || bounds != drawn_bounds)
+			damaged_layers = all_layers;
+		//Without damage tracking a graphable may have changed without being
+		//invalidated, so nothing it remembers from earlier frames can be used
+		if (!damage_tracking) {
+			for (Graphable* graphable : graphables)
+				graphable->discard_cache();
+		}
 
-		//Draw Graphables
+		//Take each graphable's invalidation now, so that one made by another
+		//thread while this frame is built is kept for the next frame
+		std::vector<unsigned char> changed(graphables.size());
+		for (std::size_t i = 0; i < graphables.size(); ++i) {
+			changed[i] = graphables[i]->dirty.exchange(false);
+			if (changed[i])
+				damaged_layers |= graphables[i]->layer_mask;
+		}
+		redraw_mask = damaged_layers;
+		damaged_layers = 0;
+		drawn_bounds = bounds;
+
+		//Give every graphable the same view of the graph for this frame
+		Viewport view = viewport();
 		for (Graphable* graphable : graphables)
+			graphable->view = view;
+
+		//Clear
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (redraw_mask & (1 << i))
+				layers[i].clear(sf::Color::Transparent);
+		}
+		frame_stats.clear_time = phase_clock.restart().asSeconds();
+
+		//Find the graphables which are invalidated or lie on a cleared layer
+		std::vector<std::size_t> redraw;
+		frame_stats.graphables.assign(graphables.size(), GraphableStats());
+		for (std::size_t i = 0; i < graphables.size(); ++i) {
+			frame_stats.graphables[i].graphable = graphables[i];
+			if (changed[i] || (graphables[i]->layer_mask & redraw_mask))
+				redraw.push_back(i);
+		}
+
+		//Build their geometry in parallel
+		workers().parallel_for(0, redraw.size(), [this, &redraw](std::size_t i) {
+			sf::Clock prepare_clock;
+			graphables[redraw[i]]->prepare();
+			frame_stats.graphables[redraw[i]].prepare_time = prepare_clock.getElapsedTime().asSeconds();
+		});
+		frame_stats.prepare_time = phase_clock.restart().asSeconds();
+
+		//Draw them in order
+		for (std::size_t i : redraw) {
+			Graphable* graphable = graphables[i];
+			GraphableStats& stats = frame_stats.graphables[i];
+			unsigned char previous_mask = graphable->layer_mask;
+			graphable->layer_mask = 0;
+			sf::Clock draw_clock;
+			drawing_stats = &stats;
 			graphable->draw();
+			drawing_stats = nullptr;
+			stats.drawn = true;
+			stats.draw_time = draw_clock.getElapsedTime().asSeconds();
+			//A layer that was not cleared is missing anything the graphable
+			//has started drawing to it, so redraw it next time
+			damaged_layers |= graphable->layer_mask & ~previous_mask & ~redraw_mask;
+		}
+		frame_stats.draw_time = phase_clock.restart().asSeconds();
+
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (redraw_mask & (1 << i)) {
+				batches[i].flush();
+				layers[i].display();
+			}
+		}
+
+		//Headless graphs keep the result in the layers
+		if (headless) {
+			frame_stats.composite_time = phase_clock.restart().asSeconds();
+			frame_stats.status_bar_time = 0;
+			frame_stats.frame_time = frame_clock.getElapsedTime().asSeconds();
+			return;
+		}
 
 		//Draw layers
+		window.clear(bg_color);
 		sf::Sprite sprite;
 		for (sf::RenderTexture& layer : layers) {
-			layer.display();
 			sprite.setTexture(layer.getTexture());
 			window.draw(sprite);
 		}
+		frame_stats.composite_time = phase_clock.restart().asSeconds();
 
 		//Draw status bar
 		std::stringstream s;
@@ -44,21 +135,34 @@ namespace graphy
 			<< "  y=" << amap_y(static_cast<float>(sf::Mouse::getPosition(window).y))
 			<< "\t|\t" << bounds.left << "<x<" << bounds.left + bounds.width
 			<< "  " << bounds.top - bounds.height << "<y<" << bounds.top
-			<< "\t|\tframerate: " << std::fixed << framerate
+			<< "\t|\tframerate: " << std::fixed << frame_stats.framerate
 			<< "\t|\tdisplaying " << graphables.size() << " graphables"
 			<< "\t|\tviewport: " << std::setprecision(0) << width() << "x" << height()
 			<< "\t|\t" << PROG_NAME << " " << PROG_VER;
 		sbar.text = s.str();
 		sbar.draw();
+		frame_stats.status_bar_time = phase_clock.restart().asSeconds();
 
 		//Display
 		window.display();
+		frame_stats.frame_time = frame_clock.getElapsedTime().asSeconds();
+	}
+
+	const Graph::FrameStats& Graph::stats() const
+	{
+		return frame_stats;
 	}
 
 
 
 	void Graph::mainloop()
 	{
+		//There is no window to interact with
+		if (headless) {
+			update();
+			return;
+		}
+
 		bool isRunning = true;
 		sf::DoubleRect m_bounds;
 		sf::Vector2f m_cords;
@@ -68,12 +172,22 @@ namespace graphy
 
 		while (isRunning)
 		{
+			//In on-demand mode sleep until there is something to redraw,
+			//and do not count the time asleep as part of the frame
+			sf::Event event;
+			bool waited_event = false;
+			if (on_demand && !animating && !m_press && !navigation_key_pressed()) {
+				waited_event = wait_for_update(event);
+				clock.restart();
+			}
+			update_requested = false;
+
 			//Get frame time
 			dt = clock.restart().asSeconds();
 
 			//Poll events
-			sf::Event event;
-			while (window.pollEvent(event)) {
+			while (waited_event || window.pollEvent(event)) {
+				waited_event = false;
 				//Window closed
 				if (event.type == sf::Event::Closed) {
 					isRunning = false;
@@ -98,8 +212,7 @@ namespace graphy
 				//Window resize
 				if (event.type == sf::Event::Resized) {
 					window.setView(sf::View(sf::FloatRect(0.f, 0.f, static_cast<float>(width()), static_cast<float>(height()))));
-					for (sf::RenderTexture& layer : layers)
-						layer.create(static_cast<unsigned int>(width()), static_cast<unsigned int>(height()));
+					create_layers(width(true), height(true));
 				}
 			}
 
@@ -144,9 +257,32 @@ namespace graphy
 		}
 	}
 
-	void Graph::print(const std::string& filename)
+	bool Graph::wait_for_update(sf::Event& event)
+	{
+		//sf::Window::waitEvent cannot be woken from another thread, so
+		//poll at a low rate instead
+		while (!update_requested) {
+			if (window.pollEvent(event))
+				return true;
+			sf::sleep(idle_interval);
+		}
+		return false;
+	}
+
+	void Graph::resize(unsigned int width, unsigned int height)
+	{
+		if (!headless) {
+			//The resize event from the window recreates the layers
+			window.setSize(sf::Vector2u(width, height + static_cast<unsigned int>(status_bar_height)));
+			return;
+		}
+		create_layers(width, height);
+	}
+
+	sf::Image Graph::capture()
 	{
 		sf::RenderTexture screenshot;
+		screenshot.create(width(true), height(true));
 		screenshot.clear(bg_color);
 		sf::Sprite sprite;
 		for (sf::RenderTexture& layer : layers) {
@@ -154,26 +290,36 @@ namespace graphy
 			screenshot.draw(sprite);
 		}
 		screenshot.display();
-		screenshot.getTexture().copyToImage().saveToFile(filename);
+		return screenshot.getTexture().copyToImage();
+	}
+
+	void Graph::print(const std::string& filename)
+	{
+		if (!capture().saveToFile(filename))
+			std::cerr << "Unable to save screenshot " << filename << ".\n";
 	}
 
 	float Graph::height()
 	{
-		return static_cast<float>(window.getSize().y - status_bar_height);
+		return static_cast<float>(height(true));
 	}
 
 	float Graph::width()
 	{
-		return static_cast<float>(window.getSize().x);
+		return static_cast<float>(width(true));
 	}
 
 	unsigned int Graph::height(bool)
 	{
+		if (headless)
+			return layers[0].getSize().y;
 		return window.getSize().y - static_cast<unsigned int>(status_bar_height);
 	}
 
 	unsigned int Graph::width(bool)
 	{
+		if (headless)
+			return layers[0].getSize().x;
 		return window.getSize().x;
 	}
 
@@ -62,18 +62,21 @@ namespace graphy
 	{
 		tick_mode = TickMode::spacing;
 		tick_spacing = spacing;
+		invalidate();
 	}
 
 	void Axis::set_ticks_interval(double interval)
 	{
 		tick_mode = TickMode::interval;
 		tick_interval = interval;
+		invalidate();
 	}
 
 	void Axis::set_ticks(std::vector<double> ticks)
 	{
 		tick_mode = TickMode::list;
 		tick_list = ticks;
+		invalidate();
 	}
 
 	void YAxis::draw()
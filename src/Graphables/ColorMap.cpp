@@ -1,22 +1,91 @@
 #include <Graphy/Graphables/ColorMap.hpp>
+#include <algorithm>
 
 namespace graphy
 {
+	namespace
+	{
+		//Size in cells of the tiles the grid is evaluated in
+		const std::size_t tile_width = 256, tile_height = 8;
+
+		//Converts a value from 0 to 1 to a colour channel, treating values
+		//where the expression is undefined as 0
+		sf::Uint8 channel(double v)
+		{
+			return v > 0 ? static_cast<sf::Uint8>(255 * std::min(v, 1.0)) : 0;
+		}
+	}
+
 	ColorMap::ColorMap(std::function<sf::Color(double, double)> eq) :
-		eq(eq), grain_size(5)
+		eq(eq), grain_size(5), smooth(false)
 	{
 
 	}
 
-	void ColorMap::draw()
+	ColorMap::ColorMap(const Expression& red, const Expression& green, const Expression& blue) :
+		ColorMap([red, green, blue](double x, double y) {
+			return sf::Color(channel(red(x, y)), channel(green(x, y)), channel(blue(x, y)));
+		})
+	{
+		batch_eq = [red, green, blue](const double* x, double y, sf::Color* result, std::size_t count) {
+			thread_local std::vector<double> r, g, b;
+			r.resize(count);
+			g.resize(count);
+			b.resize(count);
+			red.evaluate(x, y, r.data(), count);
+			green.evaluate(x, y, g.data(), count);
+			blue.evaluate(x, y, b.data(), count);
+			for (std::size_t i = 0; i < count; ++i)
+				result[i] = sf::Color(channel(r[i]), channel(g[i]), channel(b[i]));
+		};
+	}
+
+	void ColorMap::prepare()
 	{
-		sf::RectangleShape p(sf::Vector2f(grain_size, grain_size));
-		for (float x = 0; x < canvas.width(); x += grain_size) {
-			for (float y = 0; y < canvas.height(); y += grain_size) {
-				p.setPosition(x, y);
-				p.setFillColor(eq(amap_x(x), amap_y(y)));
-				canvas.draw(Canvas::Background, p);
+		//Find the graph coordinates of each row and column of cells
+		std::vector<float> px, py;
+		for (float x = 0; x < canvas.width(); x += grain_size)
+			px.push_back(x);
+		for (float y = 0; y < canvas.height(); y += grain_size)
+			py.push_back(y);
+		std::vector<double> gx(px.size()), gy(py.size());
+		viewport().amap_x(px.data(), px.size(), gx.data());
+		viewport().amap_y(py.data(), py.size(), gy.data());
+
+		//Evaluate the grid in tiles on the worker threads, a row of a tile
+		//at a time, with each tile writing its own pixels of the image
+		std::size_t nx = px.size(), ny = py.size();
+		std::size_t tiles_x = (nx + tile_width - 1) / tile_width, tiles_y = (ny + tile_height - 1) / tile_height;
+		image.resize(static_cast<unsigned int>(nx), static_cast<unsigned int>(ny));
+		parallel_for(0, tiles_x * tiles_y, [&](std::size_t tile) {
+			std::size_t i0 = tile % tiles_x * tile_width, i1 = std::min(nx, i0 + tile_width);
+			std::size_t j0 = tile / tiles_x * tile_height, j1 = std::min(ny, j0 + tile_height);
+			thread_local std::vector<sf::Color> row;
+			row.resize(i1 - i0);
+			for (std::size_t j = j0; j < j1; ++j) {
+				evaluate(&gx[i0], gy[j], row.data(), row.size());
+				for (std::size_t i = i0; i < i1; ++i)
+					image.set(static_cast<unsigned int>(i), static_cast<unsigned int>(j), row[i - i0]);
 			}
+		});
+	}
+
+	void ColorMap::evaluate(const double* x, double y, sf::Color* result, std::size_t count) const
+	{
+		if (batch_eq) {
+			batch_eq(x, y, result, count);
+			return;
 		}
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = eq(x[i], y);
+	}
+
+	void ColorMap::draw()
+	{
+		//Each point is at the top left of its cell, so when smoothing the image
+		//is shifted to put the centre of each pixel on its point
+		float offset = smooth ? -grain_size / 2 : 0;
+		image.smooth = smooth;
+		canvas.draw(Canvas::Background, image, sf::FloatRect(offset, offset, image.width() * grain_size, image.height() * grain_size));
 	}
 }
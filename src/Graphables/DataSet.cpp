@@ -7,6 +7,27 @@
 
 namespace graphy
 {
+	namespace
+	{
+		const std::size_t max_markers = 64;
+
+		bool same_marker(const sf::ConvexShape& shape, float outline, const PointStyle& style)
+		{
+			const sf::ConvexShape& other = style.shape;
+			if (outline != style.outline ||
+				shape.getPointCount() != other.getPointCount() ||
+				shape.getOrigin() != other.getOrigin() ||
+				shape.getRotation() != other.getRotation() ||
+				shape.getScale() != other.getScale())
+				return false;
+			for (std::size_t i = 0; i < shape.getPointCount(); ++i) {
+				if (shape.getPoint(i) != other.getPoint(i))
+					return false;
+			}
+			return true;
+		}
+	}
+
 	DataSet::DataSet() :
 		DataSet(std::vector<Point>())
 	{
@@ -14,7 +35,7 @@ namespace graphy
 	}
 
 	DataSet::DataSet(std::vector<Point> point_set) :
-		points(point_set), join(false)
+		points(point_set), join(false), last_marker(0)
 	{
 
 	}
@@ -39,40 +60,68 @@ namespace graphy
 		return points.cend();
 	}
 
+	void DataSet::prepare()
+	{
+		//Map every point to window coordinates in one pass over each axis
+		std::size_t n = points.size();
+		graph_x.resize(n);
+		graph_y.resize(n);
+		window_x.resize(n);
+		window_y.resize(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			graph_x[i] = points[i].x;
+			graph_y[i] = points[i].y;
+		}
+		viewport().map_x(graph_x.data(), n, window_x.data());
+		viewport().map_y(graph_y.data(), n, window_y.data());
+
+		//Build line
+		line.clear();
+		if (join && n > 1) {
+			std::vector<sf::Vector2f> path(n);
+			for (std::size_t i = 0; i < n; ++i)
+				path[i] = sf::Vector2f(window_x[i], window_y[i]);
+			line = sfd::polyline(path, style.thickness, style.color);
+		}
+
+		//Stamp a copy of each point's marker at the point
+		instances.clear();
+		labelled.clear();
+		float width = canvas.width(), height = canvas.height();
+		for (std::size_t i = 0; i < n; ++i) {
+			const Point& point = points[i];
+			sf::Vector2f pos(window_x[i], window_y[i]);
+			const Marker& m = marker(point.style);
+
+			//Do not draw if offscreen
+			if (pos.x + m.extent < 0 || pos.x - m.extent > width ||
+				pos.y + m.extent < 0 || pos.y - m.extent > height)
+				continue;
+
+			for (const sf::Vertex& v : m.triangles)
+				instances.push_back(sf::Vertex(v.position + pos, point.style.color));
+
+			if (point.style.label.enabled && !point.style.label.text.empty())
+				labelled.push_back(std::make_pair(i, pos));
+		}
+	}
+
 	void DataSet::draw()
 	{
 		//Draw line
-		if (join && points.size() > 1) {
-			for (unsigned int i = 0; i < points.size() - 1; ++i)
-				canvas.draw(Canvas::Objects, sfd::line(map(points[i]), map(points[i + 1]), style.thickness, style.color));
-		}
+		if (line.getVertexCount() > 0)
+			canvas.draw(Canvas::Objects, line);
 
 		//Draw data points
-		sf::ConvexShape cs;
-		for (const Point& point : points) {
-			//Do not draw if offscreen
-			//if (!bounds().contains(point))
-				//continue;
-
-			cs = point.style.shape;
-			//Style the point
-			if (point.style.outline > 0) {
-				cs.setFillColor(sf::Color::Transparent);
-				cs.setOutlineColor(point.style.color);
-				cs.setOutlineThickness(point.style.outline);
-			}
-			else {
-				cs.setFillColor(point.style.color);
-				cs.setOutlineThickness(0);
-			}
-			//Draw point
-			cs.setPosition(map(point.x, point.y));
-			canvas.draw(Canvas::Objects, cs);
+		if (!instances.empty())
+			canvas.draw(Canvas::Objects, &instances[0], instances.size(), sf::Triangles);
 
-			//Draw point labels
+		//Draw point labels
+		for (const std::pair<std::size_t, sf::Vector2f>& label : labelled) {
+			const Point& point = points[label.first];
 			sf::Text t(point.resolve_label(), canvas.font(), point.style.label.size);
 			t.setFillColor(point.style.label.color);
-			t.setPosition(map(point.x, point.y) + sf::Vector2f(point.style.label.offset, point.style.label.offset));
+			t.setPosition(label.second + sf::Vector2f(point.style.label.offset, point.style.label.offset));
 			switch (point.style.label.pos) {
 			case LabelStyle::below_left:
 				t.move(sf::Vector2f(-t.getLocalBounds().width, 0));
@@ -127,4 +176,45 @@ namespace graphy
 			canvas.draw(Canvas::Labels, t);
 		}
 	}
+
+	const DataSet::Marker& DataSet::marker(const PointStyle& style)
+	{
+		//Points usually share a style, so try the last marker first
+		if (last_marker < markers.size() && same_marker(markers[last_marker].shape, markers[last_marker].outline, style))
+			return markers[last_marker];
+		for (std::size_t i = 0; i < markers.size(); ++i) {
+			if (same_marker(markers[i].shape, markers[i].outline, style)) {
+				last_marker = i;
+				return markers[i];
+			}
+		}
+
+		//Stop the cache growing without bound if every point has its own shape
+		if (markers.size() >= max_markers)
+			markers.clear();
+
+		//Tessellate the shape about the point, in white so the colour can be set per point
+		Marker m;
+		m.shape = style.shape;
+		m.outline = style.outline;
+		sf::ConvexShape cs = style.shape;
+		cs.setPosition(0, 0);
+		if (style.outline > 0) {
+			cs.setFillColor(sf::Color::Transparent);
+			cs.setOutlineColor(sf::Color::White);
+			cs.setOutlineThickness(style.outline);
+		}
+		else {
+			cs.setFillColor(sf::Color::White);
+			cs.setOutlineThickness(0);
+		}
+		sfd::triangulate(cs, cs.getTransform(), m.triangles);
+		m.extent = 0;
+		for (const sf::Vertex& v : m.triangles)
+			m.extent = std::max(m.extent, std::max(std::abs(v.position.x), std::abs(v.position.y)));
+
+		markers.push_back(m);
+		last_marker = markers.size() - 1;
+		return markers.back();
+	}
 }
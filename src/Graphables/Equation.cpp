@@ -1,18 +1,150 @@
 #include <Graphy/Graphables/Equation.hpp>
 #include <SFMath.h>
 #include <SFDraw.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace graphy
 {
+	namespace
+	{
+		//Smallest grain size in pixels
+		const float min_step = 1.f / 64;
+
+		//Number of grid indices between grain_size samples, which may be
+		//halved nine times
+		const long long coarse_keys = 1 << 9;
+
+		//Largest sample index before the grid is moved away from x=0 to keep
+		//indices exact
+		const double max_index = 1e15;
+
+		//Returns true if a straight line from a to b is within tolerance of
+		//the curve, judging by the midpoint m, or if nothing will be drawn
+		bool straight(const sf::Vector2f& a, const sf::Vector2f& m, const sf::Vector2f& b, float tolerance, float height)
+		{
+			bool fa = std::isfinite(a.y), fm = std::isfinite(m.y), fb = std::isfinite(b.y);
+			if (!fa && !fm && !fb)
+				return true;
+			//Find where the curve leaves its domain
+			if (!fa || !fm || !fb)
+				return false;
+			//Do not refine offscreen
+			if (a.y < 0 && m.y < 0 && b.y < 0 || a.y > height && m.y > height && b.y > height)
+				return true;
+			return std::abs(m.y - (a.y + b.y) / 2) <= tolerance;
+		}
+
+		//Returns true if a segment which cannot be refined further contains a
+		//pole, a jump or the edge of the curve's domain rather than a steep slope
+		bool discontinuous(const sf::Vector2f& a, const sf::Vector2f& m, const sf::Vector2f& b, float tolerance)
+		{
+			if (!std::isfinite(a.y) || !std::isfinite(m.y) || !std::isfinite(b.y))
+				return true;
+			//Poles overshoot both ends, jumps stay level with one of them
+			if (m.y < std::min(a.y, b.y) - tolerance || m.y > std::max(a.y, b.y) + tolerance)
+				return true;
+			return std::min(std::abs(m.y - a.y), std::abs(m.y - b.y)) <= tolerance;
+		}
+
+		//State of Brent's method on one interval, where b is the best estimate
+		//of the root and the root lies between b and c. Values are offset by
+		//the target so that the root is a zero.
+		struct Bracket
+		{
+			double a, b, c, fa, fb, fc, d, e;
+			double limit; //Largest value at the root of a crossing rather than a pole or a jump
+			std::size_t target;
+		};
+
+		//Largest number of iterations of Brent's method
+		const unsigned int max_iterations = 100;
+
+		//Moves b to the next point at which to evaluate the equation, returning
+		//false once b is within tolerance of the root
+		bool advance(Bracket& s, double tolerance)
+		{
+			if ((s.fb > 0 && s.fc > 0) || (s.fb < 0 && s.fc < 0)) {
+				s.c = s.a;
+				s.fc = s.fa;
+				s.d = s.e = s.b - s.a;
+			}
+			if (std::abs(s.fc) < std::abs(s.fb)) {
+				s.a = s.b;
+				s.b = s.c;
+				s.c = s.a;
+				s.fa = s.fb;
+				s.fb = s.fc;
+				s.fc = s.fa;
+			}
+			double tol = 2 * std::numeric_limits<double>::epsilon() * std::abs(s.b) + tolerance / 2;
+			double m = (s.c - s.b) / 2;
+			if (std::abs(m) <= tol || s.fb == 0)
+				return false;
 
-	const double Equation::delta = 0.001;
+			if (std::abs(s.e) >= tol && std::abs(s.fa) > std::abs(s.fb)) {
+				//Try inverse quadratic interpolation, or the secant method with two points
+				double p, q, r, t = s.fb / s.fa;
+				if (s.a == s.c) {
+					p = 2 * m * t;
+					q = 1 - t;
+				}
+				else {
+					q = s.fa / s.fc;
+					r = s.fb / s.fc;
+					p = t * (2 * m * q * (q - r) - (s.b - s.a) * (r - 1));
+					q = (q - 1) * (r - 1) * (t - 1);
+				}
+				if (p > 0)
+					q = -q;
+				p = std::abs(p);
+				//Accept the step only if it stays well inside the bracket and converges quickly enough
+				if (2 * p < std::min(3 * m * q - std::abs(tol * q), std::abs(s.e * q))) {
+					s.e = s.d;
+					s.d = p / q;
+				}
+				else
+					s.d = s.e = m;
+			}
+			else
+				s.d = s.e = m;
+
+			s.a = s.b;
+			s.fa = s.fb;
+			s.b += std::abs(s.d) > tol ? s.d : (m > 0 ? tol : -tol);
+			return true;
+		}
+
+		//Returns the interval for an n-th central difference at x, which balances
+		//truncation error against rounding error in the values of the equation
+		double step(unsigned int n, double x)
+		{
+			return std::pow(std::numeric_limits<double>::epsilon(), 1.0 / (n + 2)) * std::max(1.0, std::abs(x));
+		}
+	}
 
 	Equation::Equation(std::function<double(double)> equation, LineStyle style) :
-		equation(equation), style(style), grain_size(3)
+		equation(equation), style(style), grain_size(8), tolerance(0.25f), max_evaluations(10000), fill_to(nullptr),
+		cache_step(0), cache_anchor(0)
 	{
 
 	}
 
+	Equation::Equation(BatchFunction batch_equation, LineStyle style) :
+		batch_equation(batch_equation), style(style), grain_size(8), tolerance(0.25f), max_evaluations(10000), fill_to(nullptr),
+		cache_step(0), cache_anchor(0)
+	{
+
+	}
+
+	Equation::Equation(const Expression& expression, LineStyle style) :
+		Equation(BatchFunction([expression](const double* x, double* y, std::size_t count) { expression.evaluate(x, y, count); }), style)
+	{
+		this->equation = [expression](double x) { return expression(x); };
+		derivative_equation = [expression](double x, double* result, unsigned int n) { return expression.derivatives(x, result, n); };
+	}
+
 	Equation::~Equation()
 	{
 
@@ -20,7 +152,9 @@ namespace graphy
 
 	double Equation::y(double x) const
 	{
-		return equation(x);
+		double y;
+		evaluate(&x, &y, 1);
+		return y;
 	}
 
 	double Equation::x(double y, unsigned int its) const
@@ -31,55 +165,390 @@ namespace graphy
 	double Equation::x(double y, double x0, unsigned int its) const
 	{
 		double x = x0;
-		for (unsigned int i = 0; i < its; ++i)
-			x -= this->y(x) / dy(x);
+		for (unsigned int i = 0; i < its; ++i) {
+			double d[2];
+			if (!derivatives(x, d, 1)) {
+				//Find the value and central difference together
+				double h = step(1, x);
+				double xs[3] = { x - h, x, x + h }, ys[3];
+				evaluate(xs, ys, 3);
+				d[0] = ys[1];
+				d[1] = (ys[2] - ys[0]) / (2 * h);
+			}
+			x -= (d[0] - y) / d[1];
+		}
 		return x;
 	}
 
 	double Equation::dy(double x) const
 	{
 		return dn_y(1, x);
-		//return (y(x + delta) - y(x - delta)) / (2*delta);
 	}
 
 	double Equation::dn_y(unsigned int n, double x) const
 	{
-		double* ys = new double[2 * n + 1];
-		for (unsigned int i = 0; i < 2 * n + 1; ++i)
-			ys[i] = y(x + (static_cast<int>(i) - static_cast<int>(n)) * delta);
-		return dn_rec(n, ys);
+		double d[max_dual_order + 1];
+		if (n <= max_dual_order && derivatives(x, d, n))
+			return d[n];
+
+		//The n-th central difference is the sum of (-1)^k (n choose k) f(x + (n/2 - k)h),
+		//which is evaluated a chunk of values at a time to avoid allocating
+		const unsigned int chunk = 16;
+		double h = step(n, x);
+		double xs[chunk], ys[chunk], weights[chunk];
+		double coefficient = 1, sum = 0;
+		for (unsigned int start = 0; start <= n; start += chunk) {
+			unsigned int count = std::min(chunk, n + 1 - start);
+			for (unsigned int i = 0; i < count; ++i) {
+				unsigned int k = start + i;
+				xs[i] = x + (0.5 * n - k) * h;
+				weights[i] = k % 2 ? -coefficient : coefficient;
+				coefficient = coefficient * (n - k) / (k + 1);
+			}
+			evaluate(xs, ys, count);
+			for (unsigned int i = 0; i < count; ++i)
+				sum += weights[i] * ys[i];
+		}
+		return sum / std::pow(h, static_cast<double>(n));
+	}
+
+	std::vector<double> Equation::roots(double y) const
+	{
+		return roots(y, viewport().amap_x(0), viewport().amap_x(viewport().width()));
+	}
+
+	std::vector<double> Equation::roots(double y, double left, double right) const
+	{
+		return roots(std::vector<double>(1, y), left, right).front();
+	}
+
+	std::vector<std::vector<double>> Equation::roots(const std::vector<double>& ys) const
+	{
+		return roots(ys, viewport().amap_x(0), viewport().amap_x(viewport().width()));
+	}
+
+	std::vector<std::vector<double>> Equation::roots(const std::vector<double>& ys, double left, double right) const
+	{
+		std::vector<std::vector<double>> result(ys.size());
+		if (ys.empty() || !(left <= right))
+			return result;
+
+		std::vector<double> xs, values;
+		scan(left, right, xs, values);
+
+		//Sort the targets so that those crossed by each interval can be found quickly
+		std::vector<std::size_t> order(ys.size());
+		for (std::size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&ys](std::size_t a, std::size_t b) { return ys[a] < ys[b]; });
+		std::vector<double> sorted(ys.size());
+		for (std::size_t i = 0; i < order.size(); ++i)
+			sorted[i] = ys[order[i]];
+
+		//Find every interval between samples which each target crosses
+		std::vector<Bracket> brackets;
+		for (std::size_t i = 0; i + 1 < xs.size(); ++i) {
+			double va = values[i], vb = values[i + 1];
+			if (!std::isfinite(va) || !std::isfinite(vb))
+				continue;
+			auto first = std::lower_bound(sorted.begin(), sorted.end(), std::min(va, vb));
+			auto last = std::upper_bound(first, sorted.end(), std::max(va, vb));
+			for (auto it = first; it != last; ++it) {
+				std::size_t target = order[it - sorted.begin()];
+				double fa = va - *it, fb = vb - *it;
+				//Samples on the target are recorded as the start of an interval, and
+				//only the first of a run of them is kept
+				if (fa == 0) {
+					if ((i == 0 || values[i - 1] != *it) && xs[i] >= left && xs[i] <= right)
+						result[target].push_back(xs[i]);
+					continue;
+				}
+				//A sample on the target at the end of an interval is left to the next
+				//interval, unless there is none or it is skipped as undefined
+				if (fb == 0) {
+					bool last = i + 2 == xs.size() || !std::isfinite(values[i + 2]);
+					if (last && xs[i + 1] >= left && xs[i + 1] <= right)
+						result[target].push_back(xs[i + 1]);
+					continue;
+				}
+				Bracket b;
+				b.a = xs[i];
+				b.b = b.c = xs[i + 1];
+				b.fa = fa;
+				b.fb = b.fc = fb;
+				b.d = b.e = b.b - b.a;
+				b.limit = 1e-6 * (std::abs(fa) + std::abs(fb));
+				b.target = target;
+				brackets.push_back(b);
+			}
+		}
+
+		//Refine every bracket together so that each step is one call to evaluate
+		double tolerance = std::numeric_limits<double>::epsilon() * (right - left);
+		std::vector<std::size_t> active;
+		std::vector<double> next_x, next_y;
+		for (std::size_t i = 0; i < brackets.size(); ++i)
+			active.push_back(i);
+		for (unsigned int it = 0; it < max_iterations && !active.empty(); ++it) {
+			std::size_t kept = 0;
+			next_x.clear();
+			for (std::size_t i : active) {
+				if (advance(brackets[i], tolerance)) {
+					active[kept++] = i;
+					next_x.push_back(brackets[i].b);
+				}
+			}
+			active.resize(kept);
+			next_y.resize(next_x.size());
+			if (!next_x.empty())
+				evaluate(next_x.data(), next_y.data(), next_x.size());
+			for (std::size_t i = 0; i < active.size(); ++i)
+				brackets[active[i]].fb = next_y[i] - ys[brackets[active[i]].target];
+		}
+
+		//Keep roots where the equation actually reaches the target, at whichever
+		//end of the bracket is nearer to it
+		for (const Bracket& b : brackets) {
+			double x = std::abs(b.fc) < std::abs(b.fb) ? b.c : b.b;
+			if (std::min(std::abs(b.fb), std::abs(b.fc)) <= b.limit && x >= left && x <= right)
+				result[b.target].push_back(x);
+		}
+		for (std::vector<double>& r : result)
+			std::sort(r.begin(), r.end());
+		return result;
+	}
+
+	void Equation::scan(double left, double right, std::vector<double>& x, std::vector<double>& y) const
+	{
+		x.clear();
+		y.clear();
+
+		//Reuse the last frame's samples if they cover the range, as the line
+		//already follows every feature of the curve that can be seen. They
+		//cannot be used once invalidate() has discarded their values.
+		if (!keys.empty() && cache_anchor + keys.front() * cache_step <= left && cache_anchor + keys.back() * cache_step >= right) {
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				double kx = cache_anchor + keys[i] * cache_step;
+				if (i + 1 < keys.size() && cache_anchor + keys[i + 1] * cache_step < left)
+					continue;
+				auto it = cache.find(keys[i]);
+				if (it == cache.end())
+					break;
+				x.push_back(kx);
+				y.push_back(std::isfinite(points[i].y) ? it->second : std::numeric_limits<double>::quiet_NaN());
+				if (kx >= right)
+					return;
+			}
+			x.clear();
+			y.clear();
+		}
+
+		//Wide ranges are sampled more coarsely so that no more than
+		//max_evaluations points are taken
+		double step = viewport().armap_x(std::max(grain_size, min_step));
+		double samples = std::ceil((right - left) / step) + 1;
+		if (!(samples < max_evaluations))
+			samples = max_evaluations;
+		std::size_t count = std::max<std::size_t>(2, static_cast<std::size_t>(samples));
+		x.resize(count);
+		y.resize(count);
+		for (std::size_t i = 0; i < count; ++i)
+			x[i] = left + (right - left) * i / (count - 1);
+		evaluate(x.data(), y.data(), count);
+	}
+
+	bool Equation::derivatives(double x, double* result, unsigned int n) const
+	{
+		return derivative_equation && derivative_equation(x, result, n);
+	}
+
+	void Equation::evaluate(const double* x, double* y, std::size_t count) const
+	{
+		if (batch_equation) {
+			batch_equation(x, y, count);
+			return;
+		}
+		for (std::size_t i = 0; i < count; ++i)
+			y[i] = equation(x[i]);
+	}
+
+	void Equation::discard_cache()
+	{
+		cache.clear();
 	}
 
-	double Equation::dn_rec(unsigned int n, double* ys) const
+	void Equation::prepare()
 	{
-		if (n == 0) {
-			double y = ys[0];
-			delete[] ys;
-			return y;
+		float height = canvas.height();
+		double left = amap_x(0), right = amap_x(canvas.width());
+
+		//Samples lie on a grid fixed in graph coordinates so that they can be
+		//reused when the graph is panned, until the grid spacing changes
+		double step = armap_x(std::max(grain_size, min_step));
+		double fine_step = step / coarse_keys;
+		double anchor = std::max(std::abs(left), std::abs(right)) / fine_step < max_index ? 0 : left;
+		if (fine_step != cache_step || anchor != cache_anchor) {
+			cache.clear();
+			cache_step = fine_step;
+			cache_anchor = anchor;
+		}
+
+		//Sample the curve at regular intervals
+		long long first = static_cast<long long>(std::floor((left - anchor) / step));
+		long long last = std::max(first + 1, static_cast<long long>(std::ceil((right - anchor) / step)));
+		keys.clear();
+		for (long long k = first; k <= last; ++k)
+			keys.push_back(k * coarse_keys);
+		sample(keys, points);
+		std::size_t samples = points.size();
+		refine.assign(points.size() - 1, true);
+		std::size_t pending = refine.size();
+
+		//Halve every segment which is not straight enough, a level at a time
+		//so that a limited number of evaluations is shared along the curve
+		while (pending > 0 && samples + pending <= max_evaluations) {
+			//Evaluate the midpoints of the whole level together
+			mid_keys.clear();
+			for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+				if (refine[i])
+					mid_keys.push_back((keys[i] + keys[i + 1]) / 2);
+			}
+			sample(mid_keys, mid_points);
+			samples += mid_keys.size();
+
+			next_points.clear();
+			next_keys.clear();
+			next_refine.clear();
+			pending = 0;
+			for (std::size_t i = 0, j = 0; i + 1 < points.size(); ++i) {
+				const sf::Vector2f& a = points[i], &b = points[i + 1];
+				next_points.push_back(a);
+				next_keys.push_back(keys[i]);
+				if (!refine[i]) {
+					next_refine.push_back(false);
+					continue;
+				}
+
+				long long key = mid_keys[j];
+				sf::Vector2f m = mid_points[j++];
+				bool smooth = straight(a, m, b, tolerance, height);
+				if (!smooth && keys[i + 1] - keys[i] < 4) {
+					//Break the line rather than joining across a discontinuity
+					if (discontinuous(a, m, b, tolerance))
+						m.y = std::numeric_limits<float>::quiet_NaN();
+					smooth = true;
+				}
+				next_points.push_back(m);
+				next_keys.push_back(key);
+				next_refine.push_back(!smooth);
+				next_refine.push_back(!smooth);
+				if (!smooth)
+					pending += 2;
+			}
+			next_points.push_back(points.back());
+			next_keys.push_back(keys.back());
+			points.swap(next_points);
+			keys.swap(next_keys);
+			refine.swap(next_refine);
+		}
+
+		//Forget samples far offscreen
+		if (cache.size() > 4 * points.size()) {
+			long long margin = (last - first) * coarse_keys;
+			long long lo = first * coarse_keys - margin, hi = last * coarse_keys + margin;
+			for (auto it = cache.begin(); it != cache.end();) {
+				if (it->first < lo || it->first > hi)
+					it = cache.erase(it);
+				else
+					++it;
+			}
+		}
+		curve = sfd::polyline(points, style.thickness, style.color);
+
+		if (style.label.enabled)
+			label_position = map(style.label.x, y(style.label.x));
+
+		//Build inequality region
+		region.clear();
+		if (style.inequality.enabled) {
+			//Find the other edge of the region at each point, either the edge of
+			//the window or the bounding curve evaluated in one call
+			float edge = style.inequality.region == InequalityStyle::greater_than ? 0 : canvas.height();
+			if (fill_to) {
+				fill_x.resize(keys.size());
+				fill_y.resize(keys.size());
+				for (std::size_t i = 0; i < keys.size(); ++i)
+					fill_x[i] = cache_anchor + keys[i] * cache_step;
+				fill_to->evaluate(fill_x.data(), fill_y.data(), fill_y.size());
+			}
+
+			//The region is one triangle strip of pairs of points, one on the curve
+			//and one on the other edge. Gaps at breaks in either edge are bridged
+			//by repeating a vertex either side, which adds empty triangles.
+			region.setPrimitiveType(sf::TrianglesStrip);
+			bool broken = false;
+			sf::Vector2f last_a, last_b;
+			for (std::size_t i = 0; i < points.size(); ++i) {
+				sf::Vector2f a = points[i], b(a.x, fill_to ? map_y(fill_y[i]) : edge);
+				if (!std::isfinite(a.y) || !std::isfinite(b.y)) {
+					broken = true;
+					continue;
+				}
+				if (region.getVertexCount() > 0) {
+					if (broken) {
+						region.append(region[region.getVertexCount() - 1]);
+						region.append(sf::Vertex(a, style.inequality.color));
+					}
+					else if ((last_a.y - last_b.y) * (a.y - b.y) < 0) {
+						//Pinch the strip where the curves cross so that it does not fold over
+						float t = (last_a.y - last_b.y) / ((last_a.y - last_b.y) - (a.y - b.y));
+						sf::Vector2f cross = last_a + (a - last_a) * t;
+						region.append(sf::Vertex(cross, style.inequality.color));
+						region.append(sf::Vertex(cross, style.inequality.color));
+					}
+				}
+				region.append(sf::Vertex(a, style.inequality.color));
+				region.append(sf::Vertex(b, style.inequality.color));
+				last_a = a;
+				last_b = b;
+				broken = false;
+			}
 		}
-		else {
-			for (unsigned int i = 0; i < 2 * n - 1; ++i)
-				ys[i] = (ys[i + 2] - ys[i]) / (2 * delta);
-			return dn_rec(n - 1, ys);
+	}
+
+	void Equation::sample(const std::vector<long long>& keys, std::vector<sf::Vector2f>& result)
+	{
+		//Evaluate every value which is not cached in one call
+		missing.clear();
+		missing_x.clear();
+		for (long long key : keys) {
+			if (cache.find(key) == cache.end()) {
+				missing.push_back(key);
+				missing_x.push_back(cache_anchor + key * cache_step);
+			}
 		}
+		missing_y.resize(missing_x.size());
+		if (!missing.empty())
+			evaluate(missing_x.data(), missing_y.data(), missing.size());
+		for (std::size_t i = 0; i < missing.size(); ++i)
+			cache.emplace(missing[i], missing_y[i]);
+
+		result.resize(keys.size());
+		for (std::size_t i = 0; i < keys.size(); ++i)
+			result[i] = sf::Vector2f(map_x(cache_anchor + keys[i] * cache_step), map_y(cache[keys[i]]));
 	}
 
 	void Equation::draw()
 	{
 		//Draw the curve
-		unsigned int no_of_points = static_cast<unsigned int>(canvas.width() / grain_size);
-		for (unsigned int i = 0; i < no_of_points; ++i)
-			canvas.draw(Canvas::Objects, sfd::line(
-				sf::Vector2f{ i*grain_size, map_y(y(amap_x(i*grain_size))) },
-				sf::Vector2f{ (i + 1)*grain_size, map_y(y(amap_x((i + 1)*grain_size))) },
-				style.thickness, style.color));
+		canvas.draw(Canvas::Objects, curve);
 
 		//Draw the label
 		if (style.label.enabled) {
 			sf::Text t(style.label.text, canvas.font(), style.label.size);
 			t.setFillColor(style.label.color);
 			//Position
-			sf::Vector2f pos(map(style.label.x, y(style.label.x)));
+			sf::Vector2f pos(label_position);
 			switch (style.label.pos) {
 			case LabelStyle::below_left:
 				t.setPosition(pos + sf::Vector2f(-t.getLocalBounds().width, 0));
@@ -101,32 +570,7 @@ namespace graphy
 		}
 
 		//Draw inequality region
-		if (style.inequality.enabled) {
-
-			//Make vertex array of points along curve
-			unsigned int no_of_points = static_cast<unsigned int>(canvas.width() / grain_size);
-			sf::VertexArray curve = sf::VertexArray(sf::LinesStrip, no_of_points);
-			for (unsigned int i = 0; i < no_of_points; ++i)
-				curve[i] = sf::Vertex(
-					sf::Vector2f(
-						i*grain_size,
-						map_y(y(amap_x(i*grain_size)))),
-					style.color);
-
-			//The region is drawn as a series of quadrilaterals between two
-			//adjacent points on the curve and two points at an appropriate
-			//side of the window
-			float y_value = style.inequality.region == InequalityStyle::greater_than ? 0 : canvas.height();
-			//Make shape, add vertices, colour and draw
-			sf::ConvexShape cs(4);
-			cs.setFillColor(style.inequality.color);
-			for (unsigned int i = 0; i < no_of_points - 1; i++) {
-				cs.setPoint(0, curve[i].position);
-				cs.setPoint(1, sf::Vector2f(curve[i].position.x, y_value));
-				cs.setPoint(2, sf::Vector2f(curve[i + 1].position.x, y_value));
-				cs.setPoint(3, curve[i + 1].position);
-				canvas.draw(Canvas::Background, cs);
-			}
-		}
+		if (region.getVertexCount() > 0)
+			canvas.draw(Canvas::Background, region);
 	}
 }
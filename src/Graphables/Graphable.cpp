@@ -6,7 +6,39 @@ namespace graphy
 {
 
 	Graphable::Graphable() :
-		graph(nullptr), canvas(this)
+		graph(nullptr), canvas(this), dirty(true), layer_mask(0)
+	{
+
+	}
+
+	Graphable::Graphable(const Graphable& other) :
+		graph(nullptr), canvas(this), view(other.view), dirty(true), layer_mask(0)
+	{
+
+	}
+
+	Graphable& Graphable::operator=(const Graphable& other)
+	{
+		//The canvas and graph belong to this graphable, not the one copied
+		view = other.view;
+		dirty = true;
+		return *this;
+	}
+
+	void Graphable::invalidate()
+	{
+		discard_cache();
+		dirty = true;
+		if (graph)
+			graph->request_update();
+	}
+
+	void Graphable::prepare()
+	{
+
+	}
+
+	void Graphable::discard_cache()
 	{
 
 	}
@@ -18,12 +50,71 @@ namespace graphy
 
 	void Graphable::Canvas::draw(Layer layer, const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
 	{
-		return graphable->graph->layers[layer].draw(vertices, count, type, states);
+		//Layers which are not being redrawn already hold this graphable
+		Graph* graph = graphable->graph;
+		graphable->layer_mask |= 1 << layer;
+		if (!(graph->redraw_mask & (1 << layer)))
+			return;
+
+		xsf::VertexBatch& batch = graph->batches[layer];
+		std::size_t submitted = batch.submitted(), capacity = batch.capacity();
+		batch.draw(graph->layers[layer], vertices, count, type, states);
+		record(batch, submitted, capacity);
 	}
 
 	void Graphable::Canvas::draw(Layer layer, const sf::Drawable& drawable, const sf::RenderStates& states)
 	{
-		return graphable->graph->layers[layer].draw(drawable, states);
+		Graph* graph = graphable->graph;
+		graphable->layer_mask |= 1 << layer;
+		if (!(graph->redraw_mask & (1 << layer)))
+			return;
+
+		xsf::VertexBatch& batch = graph->batches[layer];
+		std::size_t submitted = batch.submitted(), capacity = batch.capacity();
+		batch.draw(graph->layers[layer], drawable, states);
+		record(batch, submitted, capacity);
+	}
+
+	void Graphable::Canvas::draw(Layer layer, xsf::Raster& raster, const sf::FloatRect& area)
+	{
+		Graph* graph = graphable->graph;
+		graphable->layer_mask |= 1 << layer;
+		if (!(graph->redraw_mask & (1 << layer)) || raster.width() == 0 || raster.height() == 0)
+			return;
+
+		//Texture coordinates are in pixels
+		float w = static_cast<float>(raster.width()), h = static_cast<float>(raster.height());
+		float right = area.left + area.width, bottom = area.top + area.height;
+		sf::Vertex quad[4] = {
+			sf::Vertex(sf::Vector2f(area.left, area.top), sf::Vector2f(0, 0)),
+			sf::Vertex(sf::Vector2f(right, area.top), sf::Vector2f(w, 0)),
+			sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(w, h)),
+			sf::Vertex(sf::Vector2f(area.left, bottom), sf::Vector2f(0, h)) };
+
+		xsf::VertexBatch& batch = graph->batches[layer];
+		std::size_t submitted = batch.submitted(), capacity = batch.capacity();
+		batch.draw(graph->layers[layer], quad, 4, sf::Quads, sf::RenderStates(&raster.upload()));
+		record(batch, submitted, capacity);
+	}
+
+	void Graphable::Canvas::record(const xsf::VertexBatch& batch, std::size_t submitted, std::size_t capacity)
+	{
+		Graph::GraphableStats* stats = graphable->graph->drawing_stats;
+		if (stats) {
+			++stats->draw_calls;
+			stats->vertices += batch.submitted() - submitted;
+			stats->bytes_allocated += batch.capacity() - capacity;
+		}
+	}
+
+	void Graphable::parallel_for(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body)
+	{
+		if (graph) {
+			graph->workers().parallel_for(begin, end, body);
+			return;
+		}
+		for (std::size_t i = begin; i < end; ++i)
+			body(i);
 	}
 
 	sf::DoubleRect& Graphable::bounds()
@@ -31,40 +122,14 @@ namespace graphy
 		return graph->bounds;
 	}
 
-	//Convert from graph coordinates to window coordinates
-
-	//Absolute coordinates
-	sf::Vector2f Graphable::map(double x, double y) { return graph->map(x, y); }
-	sf::Vector2f Graphable::map(sf::Vector2d p) { return graph->map(p); }
-	float Graphable::map_x(double x) { return graph->map_x(x); }
-	float Graphable::map_y(double y) { return graph->map_y(y); }
-	//Relative coordinates
-	sf::Vector2f Graphable::rmap(double x, double y) { return graph->rmap(x, y); }
-	sf::Vector2f Graphable::rmap(sf::Vector2d p) { return graph->rmap(p); }
-	float Graphable::rmap_x(double x) { return graph->rmap_x(x); }
-	float Graphable::rmap_y(double y) { return graph->rmap_y(y); }
-
-	//Convert from window coordinates to graph coordinates
-
-	//Absolute coordinates
-	sf::Vector2d Graphable::amap(float x, float y) { return graph->amap(x, y); }
-	sf::Vector2d Graphable::amap(sf::Vector2f p) { return graph->amap(p); }
-	double Graphable::amap_x(float x) { return graph->amap_x(x); }
-	double Graphable::amap_y(float y) { return graph->amap_y(y); }
-	//Relative coordinate
-	sf::Vector2d Graphable::armap(float x, float y) { return graph->armap(x, y); }
-	sf::Vector2d Graphable::armap(sf::Vector2f p) { return graph->armap(p); }
-	double Graphable::armap_x(float x) { return graph->armap_x(x); }
-	double Graphable::armap_y(float y) { return graph->armap_y(y); }
-
 	float Graphable::Canvas::width()
 	{
-		return graphable->graph->width();
+		return graphable->view.width();
 	}
 
 	float Graphable::Canvas::height()
 	{
-		return graphable->graph->height();
+		return graphable->view.height();
 	}
 
 	Graphable::Canvas::Canvas(Graphable* graphable) : graphable(graphable) {}
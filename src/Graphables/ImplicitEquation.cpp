@@ -1,33 +1,568 @@
 #include <Graphy/Graphables/ImplicitEquation.hpp>
+#include <SFDraw.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace graphy
 {
+	namespace
+	{
+		//Number of evaluations used to improve each crossing of the curve
+		const int refinements = 3;
+
+		//Boxes of the quadtree at most this many cells across are not divided further
+		const std::size_t leaf_cells = 4;
+
+		//Size in points of the tiles the grid is evaluated in
+		const std::size_t tile_width = 256, tile_height = 8;
+
+		//Largest distance in pixels between a traced line and the curve it follows
+		const double trace_tolerance = 0.25;
+
+		//Shortest step in pixels taken when tracing before the line is ended
+		const double min_step = 0.25;
+
+		//Most steps taken in each direction from a seed when tracing
+		const std::size_t max_steps = 1 << 16;
+
+		//Distance in pixels either side of a point used to estimate the gradient
+		const double difference = 1e-2;
+
+		//Most Newton steps taken to move a point onto the curve, and the step
+		//in pixels below which it is on the curve
+		const int corrections = 8;
+		const double converged = 1e-2;
+
+		//Range of cells of the grid, from i0, j0 up to but not including i1, j1
+		struct Box
+		{
+			std::size_t i0, j0, i1, j1;
+		};
+	}
 
 	ImplicitEquation::ImplicitEquation(std::function<double(double, double)> equation, LineStyle style) :
-		equation(equation), style(style), label_pos_set(false), grain_size(3)
+		equation(equation), style(style), label_found(false), grain_size(3), trace(false), trace_spacing(16)
 	{
 
 	}
 
+	ImplicitEquation::ImplicitEquation(const Expression& expression, LineStyle style) :
+		ImplicitEquation([expression](double x, double y) { return expression(x, y); }, style)
+	{
+		batch_equation = [expression](const double* x, double y, double* result, std::size_t count) {
+			expression.evaluate(x, y, result, count);
+		};
+		interval_equation = [expression](const Interval& x, const Interval& y) {
+			return expression(x, y);
+		};
+	}
+
+	void ImplicitEquation::prepare()
+	{
+		curve.clear();
+		region.clear();
+		lines.clear();
+		segments.clear();
+		label_found = false;
+
+		//The inequality region is filled from the full grid, so the curve is
+		//only traced from a coarse grid without it
+		bool fill = style.inequality.enabled;
+		bool greater = style.inequality.region == InequalityStyle::greater_than;
+		bool tracing = trace && !fill;
+		float spacing = tracing ? trace_spacing : grain_size;
+		if (!(spacing > 0))
+			return;
+
+		//Find the graph coordinates of each row and column of the grid, which
+		//covers the whole canvas
+		std::vector<float> px, py;
+		for (float x = 0; x < canvas.width() + spacing; x += spacing)
+			px.push_back(x);
+		for (float y = 0; y < canvas.height() + spacing; y += spacing)
+			py.push_back(y);
+		std::vector<double> gx(px.size()), gy(py.size());
+		viewport().amap_x(px.data(), px.size(), gx.data());
+		viewport().amap_y(py.data(), py.size(), gy.data());
+		std::size_t nx = px.size(), ny = py.size();
+		if (nx < 2 || ny < 2)
+			return;
+
+		//Find the cells the curve may pass through. Where the equation can be
+		//bounded, boxes of cells are divided until they are small or provably
+		//on one side of the curve.
+		cells.clear();
+		Interval bounds;
+		if (!bound(Interval(gx.front(), gx.back()), Interval(gy.back(), gy.front()), bounds)) {
+			for (std::size_t c = 0; c < (nx - 1) * (ny - 1); ++c)
+				cells.push_back(c);
+		}
+		else {
+			std::vector<Box> boxes(1, Box{ 0, 0, nx - 1, ny - 1 });
+			while (!boxes.empty()) {
+				Box b = boxes.back();
+				boxes.pop_back();
+				bound(Interval(gx[b.i0], gx[b.i1]), Interval(gy[b.j1], gy[b.j0]), bounds);
+				if (std::isfinite(bounds.lower) && std::isfinite(bounds.upper) && (bounds.lower > 0 || bounds.upper <= 0)) {
+					if (fill && (bounds.lower > 0) == greater) {
+						const sf::Color& color = style.inequality.color;
+						sf::Vector2f a(px[b.i0], py[b.j0]), c(px[b.i1], py[b.j1]);
+						for (const sf::Vector2f& p : { a, sf::Vector2f(c.x, a.y), c, a, c, sf::Vector2f(a.x, c.y) })
+							region.push_back(sf::Vertex(p, color));
+					}
+					continue;
+				}
+				std::size_t w = b.i1 - b.i0, h = b.j1 - b.j0;
+				if (w <= leaf_cells && h <= leaf_cells) {
+					for (std::size_t j = b.j0; j < b.j1; ++j) {
+						for (std::size_t i = b.i0; i < b.i1; ++i)
+							cells.push_back(j * (nx - 1) + i);
+					}
+					continue;
+				}
+				std::size_t mi = w > leaf_cells ? b.i0 + w / 2 : b.i1, mj = h > leaf_cells ? b.j0 + h / 2 : b.j1;
+				boxes.push_back(Box{ b.i0, b.j0, mi, mj });
+				if (mi < b.i1)
+					boxes.push_back(Box{ mi, b.j0, b.i1, mj });
+				if (mj < b.j1)
+					boxes.push_back(Box{ b.i0, mj, mi, b.j1 });
+				if (mi < b.i1 && mj < b.j1)
+					boxes.push_back(Box{ mi, mj, b.i1, b.j1 });
+			}
+			std::sort(cells.begin(), cells.end());
+		}
+
+		//Evaluate the corners of the cells in tiles on the worker threads, in
+		//runs of neighbouring points along each row of a tile
+		needed.assign(nx * ny, 0);
+		for (std::size_t c : cells) {
+			std::size_t i = c % (nx - 1), j = c / (nx - 1);
+			needed[j * nx + i] = needed[j * nx + i + 1] = needed[(j + 1) * nx + i] = needed[(j + 1) * nx + i + 1] = 1;
+		}
+		values.resize(nx * ny);
+		std::size_t tiles_x = (nx + tile_width - 1) / tile_width, tiles_y = (ny + tile_height - 1) / tile_height;
+		parallel_for(0, tiles_x * tiles_y, [&](std::size_t tile) {
+			std::size_t i0 = tile % tiles_x * tile_width, i1 = std::min(nx, i0 + tile_width);
+			std::size_t j0 = tile / tiles_x * tile_height, j1 = std::min(ny, j0 + tile_height);
+			for (std::size_t j = j0; j < j1; ++j) {
+				for (std::size_t i = i0; i < i1;) {
+					if (!needed[j * nx + i]) {
+						++i;
+						continue;
+					}
+					std::size_t start = i;
+					while (i < i1 && needed[j * nx + i])
+						++i;
+					evaluate(&gx[start], gy[j], &values[j * nx + start], i - start);
+				}
+			}
+		});
+
+		//Edges along rows are numbered first, followed by edges down columns
+		std::size_t row_edges = (nx - 1) * ny;
+		auto right_edge = [nx](std::size_t i, std::size_t j) { return j * (nx - 1) + i; };
+		auto down_edge = [nx, row_edges](std::size_t i, std::size_t j) { return row_edges + j * nx + i; };
+		std::size_t edges = row_edges + nx * (ny - 1);
+		auto ends = [nx, row_edges](std::size_t edge, std::size_t& a, std::size_t& b) {
+			if (edge < row_edges) {
+				a = edge / (nx - 1) * nx + edge % (nx - 1);
+				b = a + 1;
+			}
+			else {
+				a = edge - row_edges;
+				b = a + nx;
+			}
+		};
+		crossings.resize(edges);
+		tested.assign(edges, 0);
+		crossed.assign(edges, 0);
+
+		//Collect the edges of the cells which change sign, then find where the
+		//curve crosses them on the worker threads
+		pending.clear();
+		for (std::size_t c : cells) {
+			std::size_t i = c % (nx - 1), j = c / (nx - 1);
+			for (std::size_t edge : { right_edge(i, j), down_edge(i + 1, j), right_edge(i, j + 1), down_edge(i, j) }) {
+				if (tested[edge])
+					continue;
+				tested[edge] = 1;
+				std::size_t a, b;
+				ends(edge, a, b);
+				if ((values[a] > 0) != (values[b] > 0))
+					pending.push_back(edge);
+			}
+		}
+		parallel_for(0, pending.size(), [&](std::size_t k) {
+			std::size_t a, b;
+			ends(pending[k], a, b);
+			cross(pending[k], sf::Vector2f(px[a % nx], py[a / nx]), sf::Vector2f(px[b % nx], py[b / nx]), values[a], values[b]);
+		});
+
+		//When tracing, follow the curve from each crossing which is not on a
+		//line that has already been traced
+		if (tracing) {
+			traced.assign(edges, 0);
+			for (std::size_t edge : pending) {
+				if (!crossed[edge] || traced[edge])
+					continue;
+				traced[edge] = 1;
+				trace_line(sf::Vector2d(crossings[edge]), spacing, nx, ny);
+			}
+			curve = sfd::polyline(lines, style.thickness, style.color);
+			if (style.label.enabled)
+				reposition_label();
+			return;
+		}
+
+		//Join the crossings of each cell with marching squares
+		for (std::size_t c : cells) {
+			std::size_t i = c % (nx - 1), j = c / (nx - 1);
+			//Corners and the edges which follow them, clockwise from the top left
+			double v[4] = { values[j * nx + i], values[j * nx + i + 1], values[(j + 1) * nx + i + 1], values[(j + 1) * nx + i] };
+			if (!std::isfinite(v[0]) || !std::isfinite(v[1]) || !std::isfinite(v[2]) || !std::isfinite(v[3]))
+				continue;
+			std::size_t e[4] = { right_edge(i, j), down_edge(i + 1, j), right_edge(i, j + 1), down_edge(i, j) };
+			sf::Vector2f corners[4] = {
+				sf::Vector2f(px[i], py[j]), sf::Vector2f(px[i + 1], py[j]),
+				sf::Vector2f(px[i + 1], py[j + 1]), sf::Vector2f(px[i], py[j + 1]) };
+			double centre = (v[0] + v[1] + v[2] + v[3]) / 4;
+			if (fill)
+				fill_cell(corners, v, e, centre);
+
+			int signs = (v[0] > 0) | (v[1] > 0) << 1 | (v[2] > 0) << 2 | (v[3] > 0) << 3;
+			if (signs == 0 || signs == 15)
+				continue;
+			std::size_t found[4], n = 0;
+			for (int k = 0; k < 4; ++k) {
+				if ((v[k] > 0) != (v[(k + 1) % 4] > 0))
+					found[n++] = k;
+			}
+			if (n == 2)
+				segments.push_back(std::make_pair(e[found[0]], e[found[1]]));
+			else if (n == 4) {
+				//At a saddle, the corners on the same side as the centre are joined
+				//through it, so the lines cut off the other two corners
+				if ((centre > 0) == (v[0] > 0)) {
+					segments.push_back(std::make_pair(e[0], e[1]));
+					segments.push_back(std::make_pair(e[2], e[3]));
+				}
+				else {
+					segments.push_back(std::make_pair(e[3], e[0]));
+					segments.push_back(std::make_pair(e[1], e[2]));
+				}
+			}
+		}
+
+		//Link each edge to the segments which meet at it, leaving out
+		//segments at crossings which were found to be poles or jumps
+		links.assign(2 * edges, -1);
+		joined.assign(segments.size(), 0);
+		for (std::size_t s = 0; s < segments.size(); ++s) {
+			if (!crossed[segments[s].first] || !crossed[segments[s].second]) {
+				joined[s] = 1;
+				continue;
+			}
+			for (std::size_t edge : { segments[s].first, segments[s].second })
+				links[2 * edge + (links[2 * edge] >= 0)] = static_cast<int>(s);
+		}
+
+		//Walk along linked segments to build lines, starting from the ends of
+		//open lines and then from anywhere on closed loops
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+		for (int pass = 0; pass < 2; ++pass) {
+			for (std::size_t s = 0; s < segments.size(); ++s) {
+				if (joined[s])
+					continue;
+				std::size_t edge = segments[s].first;
+				if (pass == 0) {
+					if (links[2 * segments[s].first + 1] < 0)
+						edge = segments[s].first;
+					else if (links[2 * segments[s].second + 1] < 0)
+						edge = segments[s].second;
+					else
+						continue;
+				}
+				lines.push_back(crossings[edge]);
+				int current = static_cast<int>(s);
+				while (current >= 0 && !joined[current]) {
+					joined[current] = 1;
+					const std::pair<std::size_t, std::size_t>& segment = segments[current];
+					edge = segment.first == edge ? segment.second : segment.first;
+					lines.push_back(crossings[edge]);
+					current = links[2 * edge] == current ? links[2 * edge + 1] : links[2 * edge];
+				}
+				lines.push_back(sf::Vector2f(nan, nan));
+			}
+		}
+		curve = sfd::polyline(lines, style.thickness, style.color);
+		if (style.label.enabled)
+			reposition_label();
+	}
+
+	void ImplicitEquation::cross(std::size_t edge, sf::Vector2f a, sf::Vector2f b, double va, double vb)
+	{
+		if (!std::isfinite(va) || !std::isfinite(vb) || (va > 0) == (vb > 0))
+			return;
+
+		//Start from linear interpolation, which is kept if refining fails, since
+		//the inequality region is filled up to the crossing either way
+		crossings[edge] = a + (b - a) * static_cast<float>(va / (va - vb));
+
+		//Narrow the crossing with a few steps of the Illinois variant of the
+		//false position method, keeping the point closest to zero
+		double lo = 0, hi = 1, flo = va, fhi = vb;
+		double best = std::min(std::abs(va), std::abs(vb)), best_t = std::abs(va) < std::abs(vb) ? 0 : 1;
+		int side = 0;
+		for (int k = 0; k < refinements && flo != fhi; ++k) {
+			double t = lo + (hi - lo) * flo / (flo - fhi), ft;
+			sf::Vector2f p = a + (b - a) * static_cast<float>(t);
+			double x = amap_x(p.x);
+			evaluate(&x, amap_y(p.y), &ft, 1);
+			if (!std::isfinite(ft))
+				return;
+			if (std::abs(ft) < best) {
+				best = std::abs(ft);
+				best_t = t;
+			}
+			if (ft == 0)
+				break;
+			if ((ft > 0) == (flo > 0)) {
+				lo = t;
+				flo = ft;
+				if (side == -1)
+					fhi /= 2;
+				side = -1;
+			}
+			else {
+				hi = t;
+				fhi = ft;
+				if (side == 1)
+					flo /= 2;
+				side = 1;
+			}
+		}
+		crossings[edge] = a + (b - a) * static_cast<float>(best_t);
+
+		//Near a pole or a jump the equation does not get much closer to zero
+		//than at the ends of the edge
+		double least = std::min(std::abs(va), std::abs(vb));
+		if (best < 0.5 * least || least <= 1e-9 * std::max(std::abs(va), std::abs(vb)))
+			crossed[edge] = 1;
+	}
+
+	void ImplicitEquation::fill_cell(const sf::Vector2f* corners, const double* values, const std::size_t* edges, double centre)
+	{
+		bool greater = style.inequality.region == InequalityStyle::greater_than;
+		//Zero counts as below the curve, as it does when finding the crossings
+		auto inside = [greater](double v) { return greater ? v > 0 : !(v > 0); };
+		const sf::Color& color = style.inequality.color;
+		bool in[4];
+		int count = 0;
+		for (int k = 0; k < 4; ++k)
+			count += in[k] = inside(values[k]);
+		if (count == 0)
+			return;
+
+		//Cells wholly inside stretch the previous cell's pair of triangles if it
+		//was wholly inside too
+		if (count == 4) {
+			std::size_t n = region.size();
+			if (n >= 6 && region[n - 5].position == corners[0] && region[n - 4].position == corners[3] &&
+				region[n - 3].position == region[n - 6].position && region[n - 2].position == region[n - 4].position &&
+				region[n - 6].position.y == corners[0].y && region[n - 1].position.y == corners[3].y) {
+				region[n - 5].position = corners[1];
+				region[n - 4].position = corners[2];
+				region[n - 2].position = corners[2];
+				return;
+			}
+		}
+
+		//Where the corners inside are opposite each other and the centre is
+		//outside, they are separate triangles
+		if (count == 2 && in[0] == in[2] && !inside(centre)) {
+			for (int k = 0; k < 4; ++k) {
+				if (!in[k])
+					continue;
+				region.push_back(sf::Vertex(corners[k], color));
+				region.push_back(sf::Vertex(crossings[edges[k]], color));
+				region.push_back(sf::Vertex(crossings[edges[(k + 3) % 4]], color));
+			}
+			return;
+		}
+
+		//Otherwise the part inside is one convex polygon of the corners inside
+		//and the crossings between them, drawn as a fan of triangles
+		sf::Vector2f polygon[8];
+		int n = 0;
+		for (int k = 0; k < 4; ++k) {
+			if (in[k])
+				polygon[n++] = corners[k];
+			if (in[k] != in[(k + 1) % 4])
+				polygon[n++] = crossings[edges[k]];
+		}
+		for (int k = 1; k + 1 < n; ++k) {
+			region.push_back(sf::Vertex(polygon[0], color));
+			region.push_back(sf::Vertex(polygon[k], color));
+			region.push_back(sf::Vertex(polygon[k + 1], color));
+		}
+	}
+
+	bool ImplicitEquation::differentiate(const sf::Vector2d& p, double& value, sf::Vector2d& gradient) const
+	{
+		//Central differences either side of the point along each axis
+		double left = viewport().amap_x(0), top = viewport().amap_y(0);
+		double sx = viewport().armap_x(1), sy = viewport().armap_y(1);
+		double x[3] = { left + (p.x - difference) * sx, left + p.x * sx, left + (p.x + difference) * sx }, v[5];
+		evaluate(x, top - p.y * sy, v, 3);
+		evaluate(&x[1], top - (p.y - difference) * sy, &v[3], 1);
+		evaluate(&x[1], top - (p.y + difference) * sy, &v[4], 1);
+		value = v[1];
+		gradient = sf::Vector2d(v[2] - v[0], v[4] - v[3]) / (2 * difference);
+		return std::isfinite(value) && std::isfinite(gradient.x) && std::isfinite(gradient.y) && (gradient.x != 0 || gradient.y != 0);
+	}
+
+	bool ImplicitEquation::correct(sf::Vector2d& p, sf::Vector2d& gradient) const
+	{
+		for (int k = 0; k < corrections; ++k) {
+			double value;
+			if (!differentiate(p, value, gradient))
+				return false;
+			sf::Vector2d step = gradient * (value / (gradient.x * gradient.x + gradient.y * gradient.y));
+			p -= step;
+			if (step.x * step.x + step.y * step.y < converged * converged)
+				return true;
+		}
+		return false;
+	}
+
+	void ImplicitEquation::trace_line(sf::Vector2d seed, float spacing, std::size_t nx, std::size_t ny)
+	{
+		//Seeds which move further than the grid spacing onto the curve belong
+		//to another part of it
+		sf::Vector2d gradient, moved = seed;
+		if (!correct(seed, gradient))
+			return;
+		moved -= seed;
+		if (moved.x * moved.x + moved.y * moved.y > spacing * spacing)
+			return;
+		auto tangent = [](const sf::Vector2d& g) {
+			double length = std::sqrt(g.x * g.x + g.y * g.y);
+			return sf::Vector2d(-g.y / length, g.x / length);
+		};
+		const sf::Vector2d start = tangent(gradient);
+		const double max_step = spacing, margin = spacing;
+		const double width = canvas.width(), height = canvas.height();
+
+		//Follows the curve from the seed in one direction, adding points to the
+		//path, and returns true if it came back around to the seed
+		auto follow = [&](double direction) {
+			sf::Vector2d p = seed, t = start * direction;
+			double step = max_step / 4, travelled = 0;
+			for (std::size_t n = 0; n < max_steps; ++n) {
+				if (p.x < -margin || p.y < -margin || p.x > width + margin || p.y > height + margin)
+					return false;
+
+				//Predict along the tangent and correct back onto the curve. The step
+				//is halved if the correction went much further than the step, which
+				//happens when it jumps to another part of the curve, or if the curve
+				//bends too far from the chord between the points.
+				sf::Vector2d q = p + t * step, g, u;
+				double chord = 0, sagitta = 0;
+				bool accepted = correct(q, g);
+				if (accepted) {
+					u = tangent(g);
+					if (u.x * t.x + u.y * t.y < 0)
+						u = -u;
+					sf::Vector2d d = q - p;
+					chord = std::sqrt(d.x * d.x + d.y * d.y);
+					sagitta = chord * std::acos(std::max(-1.0, std::min(1.0, u.x * t.x + u.y * t.y))) / 8;
+					accepted = chord > step / 2 && chord < 2 * step && sagitta <= trace_tolerance;
+				}
+				if (!accepted) {
+					//The curve ends at a singular point, a pole or a jump
+					if (step <= min_step)
+						return false;
+					step = std::max(min_step, step / 2);
+					continue;
+				}
+				mark(p, q, spacing, nx, ny);
+				travelled += chord;
+
+				//A closed loop has come back to the seed when the chord passes close
+				//by it heading the way the line started
+				sf::Vector2d d = q - p, e = seed - p;
+				double along = std::max(0.0, std::min(1.0, (e.x * d.x + e.y * d.y) / (chord * chord)));
+				sf::Vector2d off = e - d * along;
+				if (travelled > chord && off.x * off.x + off.y * off.y < 4 * trace_tolerance * trace_tolerance &&
+					u.x * start.x * direction + u.y * start.y * direction > 0.5) {
+					path.push_back(seed);
+					return true;
+				}
+				path.push_back(q);
+				p = q;
+				t = u;
+
+				//Lengthen the step where the curve is straight and shorten it where it
+				//bends, keeping the sagitta of the next step near the tolerance
+				double scale = std::sqrt(trace_tolerance / std::max(sagitta, 1e-3 * trace_tolerance));
+				step = std::max(min_step, std::min(max_step, step * std::max(0.5, std::min(2.0, scale))));
+			}
+			return false;
+		};
+
+		//Trace backwards then reverse the path so that it continues forwards
+		//through the seed
+		path.clear();
+		bool closed = follow(-1);
+		std::reverse(path.begin(), path.end());
+		path.push_back(seed);
+		if (!closed)
+			follow(1);
+		if (path.size() < 2)
+			return;
+		for (const sf::Vector2d& p : path)
+			lines.push_back(sf::Vector2f(static_cast<float>(p.x), static_cast<float>(p.y)));
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+		lines.push_back(sf::Vector2f(nan, nan));
+	}
+
+	void ImplicitEquation::mark(const sf::Vector2d& a, const sf::Vector2d& b, float spacing, std::size_t nx, std::size_t ny)
+	{
+		//Columns of the grid between the ends cross edges down them, and rows
+		//cross edges along them
+		std::size_t row_edges = (nx - 1) * ny;
+		for (double k = std::floor(std::min(a.x, b.x) / spacing) + 1; k * spacing <= std::max(a.x, b.x); ++k) {
+			double j = std::floor((a.y + (b.y - a.y) * (k * spacing - a.x) / (b.x - a.x)) / spacing);
+			if (k >= 0 && k < nx && j >= 0 && j + 1 < ny)
+				traced[row_edges + static_cast<std::size_t>(j) * nx + static_cast<std::size_t>(k)] = 1;
+		}
+		for (double k = std::floor(std::min(a.y, b.y) / spacing) + 1; k * spacing <= std::max(a.y, b.y); ++k) {
+			double i = std::floor((a.x + (b.x - a.x) * (k * spacing - a.y) / (b.y - a.y)) / spacing);
+			if (k >= 0 && k < ny && i >= 0 && i + 1 < nx)
+				traced[static_cast<std::size_t>(k) * (nx - 1) + static_cast<std::size_t>(i)] = 1;
+		}
+	}
+
 	void ImplicitEquation::draw()
 	{
 		//Draw label
-		if (style.label.enabled && label_pos_set) {
+		if (style.label.enabled && label_found) {
 			sf::Text t(style.label.text, canvas.font(), style.label.size);
 			t.setFillColor(style.label.color);
 			//Position
 			switch (style.label.pos) {
 			case LabelStyle::below_left:
-				t.setPosition(map(label_pos_) + sf::Vector2f(-t.getLocalBounds().width, 0));
+				t.setPosition(label_position + sf::Vector2f(-t.getLocalBounds().width, 0));
 				break;
 			case LabelStyle::above_left:
-				t.setPosition(map(label_pos_) + sf::Vector2f(-t.getLocalBounds().width, -t.getLocalBounds().height * 2));
+				t.setPosition(label_position + sf::Vector2f(-t.getLocalBounds().width, -t.getLocalBounds().height * 2));
 				break;
 			case LabelStyle::above_right:
-				t.setPosition(map(label_pos_) + sf::Vector2f(0, -t.getLocalBounds().height * 2));
+				t.setPosition(label_position + sf::Vector2f(0, -t.getLocalBounds().height * 2));
 				break;
 			case LabelStyle::below_right:
-				t.setPosition(map(label_pos_) + sf::Vector2f(0, 0));
+				t.setPosition(label_position + sf::Vector2f(0, 0));
 				break;
 			default:
 				break;
@@ -36,54 +571,56 @@ namespace graphy
 			canvas.draw(Canvas::Labels, t);
 		}
 
+		if (curve.getVertexCount() > 0)
+			canvas.draw(Canvas::Objects, curve);
+		if (!region.empty())
+			canvas.draw(Canvas::Background, &region[0], region.size(), sf::Triangles);
+	}
 
-		sf::RectangleShape p(sf::Vector2f(grain_size, grain_size));
-		sf::Color color = style.color;
-
-		if (!label_pos_set && style.label.enabled) {
-			reposition_label();
+	void ImplicitEquation::evaluate(const double* x, double y, double* result, std::size_t count) const
+	{
+		if (batch_equation) {
+			batch_equation(x, y, result, count);
+			return;
 		}
+		for (std::size_t i = 0; i < count; ++i)
+			result[i] = equation(x[i], y);
+	}
 
-		//Loop through every point on the canvas separated by grain_size
-		for (float x = 0; x < canvas.width(); x += grain_size) {
-			for (float y = 0; y < canvas.height(); y += grain_size) {
-				double result = equation(amap_x(x), amap_y(y));
-				double excess = std::abs(result / armap_x(style.thickness));
-				//Draw curve
-				if (excess < 1) {
-					color.a = static_cast<sf::Uint8>(style.color.a * (1 - excess));
-					p.setPosition(x, y);
-					p.setFillColor(color);
-					canvas.draw(Canvas::Objects, p);
-				}
-				//Draw inequality
-				if (style.inequality.region == InequalityStyle::greater_than && result > 0 ||
-					style.inequality.region == InequalityStyle::less_than && result < 0) {
-					p.setPosition(x, y);
-					p.setFillColor(style.inequality.color);
-					canvas.draw(Canvas::Background, p);
-				}
-			}
-		}
+	bool ImplicitEquation::bound(const Interval& x, const Interval& y, Interval& result) const
+	{
+		if (!interval_equation)
+			return false;
+		result = interval_equation(x, y);
+		return true;
 	}
 
 	void ImplicitEquation::reposition_label()
 	{
 		static const float label_pos_tolerance = 50;
 
-		label_pos_.x = std::numeric_limits<double>().max();
-		for (float x = map_x(style.label.x) - label_pos_tolerance, xf = map_x(style.label.x) + label_pos_tolerance; x < xf; x += grain_size) {
-			for (float y = 0; y < canvas.height(); y += grain_size) {
-				double excess = std::abs(equation(amap_x(x), amap_y(y)) / armap_x(style.thickness));
-				if (excess < 1 && std::abs(amap_x(x) - style.label.x) < std::abs(label_pos_.x - style.label.x))
-					label_pos_ = sf::Vector2d(amap_x(x), amap_y(y));
+		//Find the point of the curve nearest to the label's x-position, taking
+		//the highest where several branches are as near
+		float target = map_x(style.label.x), nearest = label_pos_tolerance;
+		label_found = false;
+		auto consider = [&](const sf::Vector2f& p, float distance) {
+			if (distance < nearest || (distance == nearest && label_found && p.y < label_position.y)) {
+				nearest = distance;
+				label_position = p;
+				label_found = true;
+			}
+		};
+		for (std::size_t k = 0; k < lines.size(); ++k) {
+			const sf::Vector2f& p = lines[k];
+			if (std::isnan(p.x))
+				continue;
+			consider(p, std::abs(p.x - target));
+			//Segments which cross the label's x-position are interpolated
+			if (k + 1 < lines.size() && !std::isnan(lines[k + 1].x)) {
+				const sf::Vector2f& q = lines[k + 1];
+				if ((p.x - target) * (q.x - target) < 0)
+					consider(p + (q - p) * ((target - p.x) / (q.x - p.x)), 0);
 			}
-		}
-		if (label_pos_.x == std::numeric_limits<double>().max()) {
-			label_pos_set = false;
-		}
-		else {
-			label_pos_set = true;
 		}
 	}
 
@@ -0,0 +1,244 @@
+#include <Graphy/Graphables/ParametricCurve.hpp>
+#include <SFDraw.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace graphy
+{
+	namespace
+	{
+		//Number of parameter indices between initial samples, which may be
+		//halved nine times
+		const long long coarse_keys = 1 << 9;
+
+		//Longest segment in pixels at the finest sampling which is joined
+		//rather than treated as a jump
+		const float max_gap = 8;
+
+		bool finite(const sf::Vector2f& p)
+		{
+			return std::isfinite(p.x) && std::isfinite(p.y);
+		}
+
+		//Returns the distance from p to the segment from a to b
+		float distance(const sf::Vector2f& p, const sf::Vector2f& a, const sf::Vector2f& b)
+		{
+			sf::Vector2f d = b - a, ap = p - a;
+			float length = d.x * d.x + d.y * d.y;
+			float t = length > 0 ? std::min(std::max((ap.x * d.x + ap.y * d.y) / length, 0.f), 1.f) : 0.f;
+			sf::Vector2f q = ap - d * t;
+			return std::sqrt(q.x * q.x + q.y * q.y);
+		}
+
+		//Returns true if none of the points are in the window, and they all lie
+		//beyond the same edge of it
+		bool outside(const sf::Vector2f& a, const sf::Vector2f& m, const sf::Vector2f& b, float width, float height, float margin)
+		{
+			return a.x < -margin && m.x < -margin && b.x < -margin ||
+				a.x > width + margin && m.x > width + margin && b.x > width + margin ||
+				a.y < -margin && m.y < -margin && b.y < -margin ||
+				a.y > height + margin && m.y > height + margin && b.y > height + margin;
+		}
+
+		//Returns true if a straight line from a to b is within tolerance of
+		//the curve, judging by the midpoint m, or if nothing will be drawn
+		bool straight(const sf::Vector2f& a, const sf::Vector2f& m, const sf::Vector2f& b, float tolerance, float width, float height)
+		{
+			bool fa = finite(a), fm = finite(m), fb = finite(b);
+			if (!fa && !fm && !fb)
+				return true;
+			//Find where the curve leaves its domain
+			if (!fa || !fm || !fb)
+				return false;
+			//Do not refine offscreen
+			if (outside(a, m, b, width, height, tolerance))
+				return true;
+			return distance(m, a, b) <= tolerance;
+		}
+	}
+
+	ParametricCurve::ParametricCurve(std::function<double(double)> x_equation, std::function<double(double)> y_equation,
+		double start, double end, LineStyle style) :
+		x_equation(x_equation), y_equation(y_equation), start(start), end(end), style(style),
+		samples(128), tolerance(0.25f), max_evaluations(10000),
+		cache_start(0), cache_end(0), cache_keys(0)
+	{
+
+	}
+
+	sf::Vector2d ParametricCurve::point(double t) const
+	{
+		sf::Vector2d p;
+		evaluate(&t, &p.x, &p.y, 1);
+		return p;
+	}
+
+	void ParametricCurve::discard_cache()
+	{
+		cache.clear();
+	}
+
+	void ParametricCurve::evaluate(const double* t, double* x, double* y, std::size_t count) const
+	{
+		for (std::size_t i = 0; i < count; ++i) {
+			x[i] = x_equation ? x_equation(t[i]) : std::numeric_limits<double>::quiet_NaN();
+			y[i] = y_equation ? y_equation(t[i]) : std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+
+	void ParametricCurve::prepare()
+	{
+		float width = canvas.width(), height = canvas.height();
+		curve.clear();
+		points.clear();
+		if (!(end > start) || samples == 0)
+			return;
+
+		//Points are indexed by the parameter, so they stay valid as the graph
+		//moves until the range of the parameter changes
+		long long total = static_cast<long long>(samples) * coarse_keys;
+		if (start != cache_start || end != cache_end || total != cache_keys || cache.size() > 4 * max_evaluations) {
+			cache.clear();
+			cache_start = start;
+			cache_end = end;
+			cache_keys = total;
+		}
+
+		//Sample the curve at regular steps of the parameter
+		keys.clear();
+		for (long long k = 0; k <= static_cast<long long>(samples); ++k)
+			keys.push_back(k * coarse_keys);
+		sample(keys, points);
+		std::size_t evaluations = points.size();
+		refine.assign(points.size() - 1, true);
+		std::size_t pending = refine.size();
+
+		//Halve every segment which is not straight enough on screen, a level
+		//at a time so that a limited number of evaluations is shared along the curve
+		while (pending > 0 && evaluations + pending <= max_evaluations) {
+			mid_keys.clear();
+			for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+				if (refine[i])
+					mid_keys.push_back((keys[i] + keys[i + 1]) / 2);
+			}
+			sample(mid_keys, mid_points);
+			evaluations += mid_keys.size();
+
+			next_points.clear();
+			next_keys.clear();
+			next_refine.clear();
+			pending = 0;
+			for (std::size_t i = 0, j = 0; i + 1 < points.size(); ++i) {
+				const sf::Vector2f& a = points[i], &b = points[i + 1];
+				next_points.push_back(a);
+				next_keys.push_back(keys[i]);
+				if (!refine[i]) {
+					next_refine.push_back(false);
+					continue;
+				}
+
+				long long key = mid_keys[j];
+				sf::Vector2f m = mid_points[j++];
+				bool smooth = straight(a, m, b, tolerance, width, height);
+				if (!smooth && keys[i + 1] - keys[i] < 4) {
+					//Break the line rather than joining across a jump
+					sf::Vector2f am = m - a, mb = b - m;
+					if (!finite(a) || !finite(m) || !finite(b) ||
+						std::sqrt(am.x * am.x + am.y * am.y) > max_gap || std::sqrt(mb.x * mb.x + mb.y * mb.y) > max_gap)
+						m.x = m.y = std::numeric_limits<float>::quiet_NaN();
+					smooth = true;
+				}
+				next_points.push_back(m);
+				next_keys.push_back(key);
+				next_refine.push_back(!smooth);
+				next_refine.push_back(!smooth);
+				if (!smooth)
+					pending += 2;
+			}
+			next_points.push_back(points.back());
+			next_keys.push_back(keys.back());
+			points.swap(next_points);
+			keys.swap(next_keys);
+			refine.swap(next_refine);
+		}
+
+		//Clip the line to the window, keeping the points either side of each
+		//segment which can be seen
+		float margin = style.thickness;
+		visible.clear();
+		bool gap = false;
+		for (std::size_t i = 0; i < points.size(); ++i) {
+			const sf::Vector2f& p = points[i];
+			bool before = i > 0 && !outside(points[i - 1], p, p, width, height, margin);
+			bool after = i + 1 < points.size() && !outside(p, p, points[i + 1], width, height, margin);
+			if (finite(p) && (before || after)) {
+				if (gap && !visible.empty())
+					visible.push_back(sf::Vector2f(std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN()));
+				visible.push_back(p);
+				gap = false;
+			}
+			else
+				gap = true;
+		}
+		curve = sfd::polyline(visible, style.thickness, style.color);
+
+		if (style.label.enabled)
+			label_position = map(point(std::min(std::max(style.label.x, start), end)));
+	}
+
+	void ParametricCurve::sample(const std::vector<long long>& keys, std::vector<sf::Vector2f>& result)
+	{
+		//Evaluate every point which is not cached in one call
+		missing.clear();
+		missing_t.clear();
+		for (long long key : keys) {
+			if (cache.find(key) == cache.end()) {
+				missing.push_back(key);
+				missing_t.push_back(cache_start + (cache_end - cache_start) * key / cache_keys);
+			}
+		}
+		missing_x.resize(missing_t.size());
+		missing_y.resize(missing_t.size());
+		if (!missing.empty())
+			evaluate(missing_t.data(), missing_x.data(), missing_y.data(), missing.size());
+		for (std::size_t i = 0; i < missing.size(); ++i)
+			cache.emplace(missing[i], sf::Vector2d(missing_x[i], missing_y[i]));
+
+		result.resize(keys.size());
+		for (std::size_t i = 0; i < keys.size(); ++i)
+			result[i] = map(cache[keys[i]]);
+	}
+
+	void ParametricCurve::draw()
+	{
+		//Draw the curve
+		canvas.draw(Canvas::Objects, curve);
+
+		//Draw the label
+		if (style.label.enabled) {
+			sf::Text t(style.label.text, canvas.font(), style.label.size);
+			t.setFillColor(style.label.color);
+			//Position
+			sf::Vector2f pos(label_position);
+			switch (style.label.pos) {
+			case LabelStyle::below_left:
+				t.setPosition(pos + sf::Vector2f(-t.getLocalBounds().width, 0));
+				break;
+			case LabelStyle::above_left:
+				t.setPosition(pos + sf::Vector2f(-t.getLocalBounds().width, -t.getLocalBounds().height * 2));
+				break;
+			case LabelStyle::above_right:
+				t.setPosition(pos + sf::Vector2f(0, -t.getLocalBounds().height * 2));
+				break;
+			case LabelStyle::below_right:
+				t.setPosition(pos + sf::Vector2f(0, 0));
+				break;
+			default:
+				break;
+			}
+
+			canvas.draw(Canvas::Labels, t);
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#include <Graphy/Graphables/PolarCurve.hpp>
+#include <cmath>
+#include <limits>
+
+namespace graphy
+{
+
+	PolarCurve::PolarCurve(std::function<double(double)> equation, double start, double end, LineStyle style) :
+		ParametricCurve(std::function<double(double)>(), std::function<double(double)>(), start, end, style),
+		equation(equation)
+	{
+
+	}
+
+	void PolarCurve::evaluate(const double* theta, double* x, double* y, std::size_t count) const
+	{
+		for (std::size_t i = 0; i < count; ++i) {
+			double r = equation ? equation(theta[i]) : std::numeric_limits<double>::quiet_NaN();
+			x[i] = r * std::cos(theta[i]);
+			y[i] = r * std::sin(theta[i]);
+		}
+	}
+
+}
@@ -0,0 +1,39 @@
+#include <Graphy/Utils/Raster.hpp>
+
+namespace xsf
+{
+
+	Raster::Raster() :
+		smooth(false), w(0), h(0)
+	{
+
+	}
+
+	void Raster::resize(unsigned int width, unsigned int height)
+	{
+		w = width;
+		h = height;
+		pixels.resize(static_cast<std::size_t>(w) * h * 4);
+	}
+
+	unsigned int Raster::width() const
+	{
+		return w;
+	}
+
+	unsigned int Raster::height() const
+	{
+		return h;
+	}
+
+	const sf::Texture& Raster::upload()
+	{
+		if (texture.getSize() != sf::Vector2u(w, h))
+			texture.create(w, h);
+		if (!pixels.empty())
+			texture.update(pixels.data());
+		texture.setSmooth(smooth);
+		return texture;
+	}
+
+}
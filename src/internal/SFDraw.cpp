@@ -1,4 +1,7 @@
 #include <SFML/Graphics.hpp>
+#include <SFDraw.h>
+#include <cmath>
+#include <algorithm>
 
 namespace sfd
 {
@@ -36,6 +39,151 @@ namespace sfd
 		return r;
 	}
 
+	namespace
+	{
+		bool finite(const sf::Vector2f& p)
+		{
+			return std::isfinite(p.x) && std::isfinite(p.y);
+		}
+
+		sf::Vector2f unit_normal(const sf::Vector2f& from, const sf::Vector2f& to)
+		{
+			sf::Vector2f d = to - from;
+			float len = std::hypot(d.x, d.y);
+			return sf::Vector2f(-d.y / len, d.x / len);
+		}
+
+		void add_pair(sf::VertexArray& strip, const sf::Vector2f& p, const sf::Vector2f& offset, const sf::Color& color)
+		{
+			strip.append(sf::Vertex(p + offset, color));
+			strip.append(sf::Vertex(p - offset, color));
+		}
+	}
+
+	sf::VertexArray polyline(
+		const std::vector<sf::Vector2f>& points,
+		float width,
+		const sf::Color& fill_color,
+		float miter_limit
+	)
+	{
+		sf::VertexArray strip(sf::TrianglesStrip);
+		float hw = width / 2;
+		std::vector<sf::Vector2f> run;
+		run.reserve(points.size());
+
+		std::size_t i = 0;
+		while (i < points.size()) {
+			//Collect the next run of finite points, skipping repeated points
+			run.clear();
+			for (; i < points.size() && finite(points[i]); ++i) {
+				if (run.empty() || points[i] != run.back())
+					run.push_back(points[i]);
+			}
+			++i;
+			if (run.size() < 2)
+				continue;
+
+			//Join to the previous run with degenerate triangles
+			sf::Vector2f offset = unit_normal(run[0], run[1]) * hw;
+			if (strip.getVertexCount() > 0) {
+				strip.append(strip[strip.getVertexCount() - 1]);
+				strip.append(sf::Vertex(run[0] + offset, fill_color));
+			}
+
+			add_pair(strip, run[0], offset, fill_color);
+			for (std::size_t j = 1; j + 1 < run.size(); ++j) {
+				sf::Vector2f n0 = unit_normal(run[j - 1], run[j]);
+				sf::Vector2f n1 = unit_normal(run[j], run[j + 1]);
+				sf::Vector2f miter = n0 + n1;
+				float miter_len = std::hypot(miter.x, miter.y);
+				//Scale the miter so that both edges stay hw from the centre line
+				float cos_half = miter_len / 2;
+				if (cos_half > 0 && 1 / cos_half <= miter_limit)
+					add_pair(strip, run[j], miter * (hw / (miter_len * cos_half)), fill_color);
+				else {
+					add_pair(strip, run[j], n0 * hw, fill_color);
+					add_pair(strip, run[j], n1 * hw, fill_color);
+				}
+			}
+			add_pair(strip, run.back(), unit_normal(run[run.size() - 2], run.back()) * hw, fill_color);
+		}
+		return strip;
+	}
+
+	void triangulate(
+		const sf::Shape& shape,
+		const sf::Transform& transform,
+		std::vector<sf::Vertex>& triangles
+	)
+	{
+		//Skip repeated points, which have no edge between them to extrude
+		std::vector<sf::Vector2f> points;
+		points.reserve(shape.getPointCount());
+		for (std::size_t i = 0; i < shape.getPointCount(); ++i) {
+			sf::Vector2f p = shape.getPoint(i);
+			if (points.empty() || p != points.back())
+				points.push_back(p);
+		}
+		while (points.size() > 1 && points.back() == points.front())
+			points.pop_back();
+		std::size_t count = points.size();
+		if (count < 3)
+			return;
+
+		//Centre of the bounding box, which like sf::Shape the fill fans out from
+		//so that star shaped markers such as crosses are filled correctly
+		sf::Vector2f low = points[0], high = points[0];
+		for (const sf::Vector2f& p : points) {
+			low.x = std::min(low.x, p.x);
+			low.y = std::min(low.y, p.y);
+			high.x = std::max(high.x, p.x);
+			high.y = std::max(high.y, p.y);
+		}
+		sf::Vector2f center = (low + high) / 2.f;
+
+		//Fill, as a fan around the centre which closes back to the first point
+		sf::Color fill = shape.getFillColor();
+		if (fill.a > 0) {
+			sf::Vertex middle(transform.transformPoint(center), fill);
+			for (std::size_t i = 0; i < count; ++i) {
+				triangles.push_back(middle);
+				triangles.push_back(sf::Vertex(transform.transformPoint(points[i]), fill));
+				triangles.push_back(sf::Vertex(transform.transformPoint(points[(i + 1) % count]), fill));
+			}
+		}
+
+		//Outline, as a ring of quads between each point and its extrusion
+		float thickness = shape.getOutlineThickness();
+		sf::Color outline = shape.getOutlineColor();
+		if (thickness == 0 || outline.a == 0)
+			return;
+		std::vector<sf::Vector2f> inner(count), outer(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			sf::Vector2f p0 = points[(i + count - 1) % count];
+			sf::Vector2f p1 = points[i];
+			sf::Vector2f p2 = points[(i + 1) % count];
+			//Outward normals of the two edges meeting at p1
+			sf::Vector2f n1 = unit_normal(p0, p1), n2 = unit_normal(p1, p2);
+			if (n1.x * (center.x - p1.x) + n1.y * (center.y - p1.y) > 0)
+				n1 = -n1;
+			if (n2.x * (center.x - p1.x) + n2.y * (center.y - p1.y) > 0)
+				n2 = -n2;
+			float factor = 1 + (n1.x * n2.x + n1.y * n2.y);
+			inner[i] = transform.transformPoint(p1);
+			outer[i] = transform.transformPoint(p1 + (n1 + n2) * (thickness / factor));
+		}
+		for (std::size_t i = 0; i < count; ++i) {
+			std::size_t j = (i + 1) % count;
+			triangles.push_back(sf::Vertex(inner[i], outline));
+			triangles.push_back(sf::Vertex(outer[i], outline));
+			triangles.push_back(sf::Vertex(inner[j], outline));
+			triangles.push_back(sf::Vertex(inner[j], outline));
+			triangles.push_back(sf::Vertex(outer[i], outline));
+			triangles.push_back(sf::Vertex(outer[j], outline));
+		}
+	}
+
 	sf::CircleShape circle(
 		const sf::Vector2f& pos,
 		float radius,
@@ -0,0 +1,145 @@
+#include <Graphy/Utils/ThreadPool.hpp>
+#include <algorithm>
+
+namespace xsf
+{
+
+	namespace
+	{
+		//Identifies the pool and queue of the current thread if it is a worker
+		thread_local const ThreadPool* current_pool = nullptr;
+		thread_local std::size_t current_queue = 0;
+	}
+
+	ThreadPool::ThreadPool(unsigned int threads) :
+		queued(0), next_queue(0), stopping(false)
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		//The thread waiting on the work does its share, so spawn one fewer worker
+		for (unsigned int i = 0; i + 1 < threads; ++i)
+			queues.emplace_back(new Queue());
+		for (std::size_t i = 0; i < queues.size(); ++i)
+			workers.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	void ThreadPool::parallel_for(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body)
+	{
+		if (end <= begin)
+			return;
+		std::size_t count = end - begin;
+		if (workers.empty() || count == 1) {
+			for (std::size_t i = begin; i < end; ++i)
+				body(i);
+			return;
+		}
+
+		//Make several chunks per thread so that stealing can even out uneven work
+		std::size_t chunks = std::min<std::size_t>(count, size() * 4);
+		Group group;
+		group.pending = chunks;
+		for (std::size_t c = 0; c < chunks; ++c) {
+			std::size_t from = begin + count * c / chunks, to = begin + count * (c + 1) / chunks;
+			Task task;
+			task.work = [from, to, &body]() {
+				for (std::size_t i = from; i < to; ++i)
+					body(i);
+			};
+			task.group = &group;
+			push(task);
+		}
+
+		//Help with the work, which may include tasks other than our own
+		std::size_t home = current_pool == this ? current_queue : 0;
+		while (group.pending > 0) {
+			if (!run_one(home))
+				std::this_thread::yield();
+		}
+		if (group.error)
+			std::rethrow_exception(group.error);
+	}
+
+	unsigned int ThreadPool::size() const
+	{
+		return static_cast<unsigned int>(workers.size() + 1);
+	}
+
+	void ThreadPool::push(const Task& task)
+	{
+		//Workers push onto their own queue to keep nested work local
+		std::size_t index = current_pool == this ? current_queue : next_queue++ % queues.size();
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			++queued;
+		}
+		{
+			std::lock_guard<std::mutex> lock(queues[index]->mutex);
+			queues[index]->tasks.push_back(task);
+		}
+		wake.notify_one();
+	}
+
+	bool ThreadPool::run_one(std::size_t home)
+	{
+		//Take the newest task from our own queue, otherwise steal the oldest from another
+		Task task;
+		bool found = false;
+		for (std::size_t k = 0; k < queues.size() && !found; ++k) {
+			Queue& queue = *queues[(home + k) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+				continue;
+			if (k == 0) {
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			}
+			else {
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+			found = true;
+		}
+		if (!found)
+			return false;
+		--queued;
+
+		try {
+			task.work();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(task.group->error_mutex);
+			if (!task.group->error)
+				task.group->error = std::current_exception();
+		}
+		//The group may be destroyed as soon as it has no pending tasks
+		--task.group->pending;
+		return true;
+	}
+
+	void ThreadPool::work(std::size_t index)
+	{
+		current_pool = this;
+		current_queue = index;
+		while (true) {
+			if (run_one(index))
+				continue;
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			wake.wait(lock, [this]() { return stopping || queued > 0; });
+			if (stopping)
+				return;
+		}
+	}
+
+}
@@ -0,0 +1,125 @@
+#include <Graphy/Utils/VertexBatch.hpp>
+#include <SFDraw.h>
+
+namespace xsf
+{
+
+	VertexBatch::VertexBatch() :
+		target(nullptr), flushed(0)
+	{
+
+	}
+
+	void VertexBatch::draw(sf::RenderTarget& target, const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+	{
+		if (count == 0)
+			return;
+
+		switch (type) {
+		case sf::Triangles:
+			bind(target, states);
+			for (std::size_t i = 0; i + 2 < count; i += 3) {
+				append(vertices[i], states.transform);
+				append(vertices[i + 1], states.transform);
+				append(vertices[i + 2], states.transform);
+			}
+			break;
+		case sf::TrianglesStrip:
+			bind(target, states);
+			for (std::size_t i = 2; i < count; ++i) {
+				append(vertices[i - 2], states.transform);
+				append(vertices[i - 1], states.transform);
+				append(vertices[i], states.transform);
+			}
+			break;
+		case sf::TrianglesFan:
+			bind(target, states);
+			for (std::size_t i = 2; i < count; ++i) {
+				append(vertices[0], states.transform);
+				append(vertices[i - 1], states.transform);
+				append(vertices[i], states.transform);
+			}
+			break;
+		case sf::Quads:
+			bind(target, states);
+			for (std::size_t i = 0; i + 3 < count; i += 4) {
+				append(vertices[i], states.transform);
+				append(vertices[i + 1], states.transform);
+				append(vertices[i + 2], states.transform);
+				append(vertices[i], states.transform);
+				append(vertices[i + 2], states.transform);
+				append(vertices[i + 3], states.transform);
+			}
+			break;
+		default:
+			//Points and lines cannot be expressed as triangles
+			flush();
+			target.draw(vertices, count, type, states);
+			flushed += count;
+			break;
+		}
+	}
+
+	void VertexBatch::draw(sf::RenderTarget& target, const sf::Drawable& drawable, const sf::RenderStates& states)
+	{
+		//Vertex arrays
+		const sf::VertexArray* array = dynamic_cast<const sf::VertexArray*>(&drawable);
+		if (array) {
+			if (array->getVertexCount() > 0)
+				draw(target, &(*array)[0], array->getVertexCount(), array->getPrimitiveType(), states);
+			return;
+		}
+
+		//Untextured shapes are tessellated in the same way as sf::Shape
+		const sf::Shape* shape = dynamic_cast<const sf::Shape*>(&drawable);
+		if (!shape || shape->getTexture() || shape->getPointCount() < 3) {
+			flush();
+			target.draw(drawable, states);
+			return;
+		}
+
+		bind(target, states);
+		sfd::triangulate(*shape, states.transform * shape->getTransform(), vertices);
+	}
+
+	void VertexBatch::flush()
+	{
+		if (!vertices.empty()) {
+			sf::RenderStates flush_states = states;
+			flush_states.transform = sf::Transform::Identity;
+			target->draw(&vertices[0], vertices.size(), sf::Triangles, flush_states);
+			flushed += vertices.size();
+			vertices.clear();
+		}
+	}
+
+	std::size_t VertexBatch::submitted() const
+	{
+		return flushed + vertices.size();
+	}
+
+	std::size_t VertexBatch::capacity() const
+	{
+		return vertices.capacity() * sizeof(sf::Vertex);
+	}
+
+	void VertexBatch::bind(sf::RenderTarget& target, const sf::RenderStates& states)
+	{
+		//Vertices are transformed as they are added, so only the remaining
+		//render states need to match to share a draw call
+		if (&target != this->target ||
+			states.texture != this->states.texture ||
+			states.shader != this->states.shader ||
+			states.blendMode != this->states.blendMode) {
+			flush();
+			this->target = &target;
+			this->states = states;
+		}
+	}
+
+	void VertexBatch::append(const sf::Vertex& vertex, const sf::Transform& transform)
+	{
+		vertices.push_back(sf::Vertex(transform.transformPoint(vertex.position), vertex.color, vertex.texCoords));
+	}
+
+}
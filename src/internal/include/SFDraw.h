@@ -34,6 +34,9 @@
 #include <SFML/Graphics/CircleShape.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Shape.hpp>
+#include <vector>
 
 
 namespace sfd
@@ -77,6 +80,49 @@ namespace sfd
 		const sf::Color& outline_color = sf::Color::Black
 	);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Returns a drawable thick line through a sequence of points
+	///
+	/// The line is tessellated into a single triangle strip with
+	/// mitered joins between segments. Joins sharper than 
+	/// \a miter_limit are bevelled instead. A point with a 
+	/// non-finite coordinate breaks the line into separate pieces.
+	///
+	/// \param points Points along the line
+	/// \param width Width in pixels of the line
+	/// \param fill_color Colour of the line
+	/// \param miter_limit Maximum ratio of the length of a miter to half the width of the line
+	///
+	/// \return sf::VertexArray of triangle strips representing the line
+	///
+	////////////////////////////////////////////////////////////
+	sf::VertexArray polyline(
+		const std::vector<sf::Vector2f>& points,
+		float width = 1,
+		const sf::Color& fill_color = sf::Color::Black,
+		float miter_limit = 4
+	);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Tessellates a shape into triangles
+	///
+	/// The fill of the shape is tessellated as a fan around the 
+	/// centre of its bounding box, as sf::Shape draws it, so the
+	/// shape must be star shaped about that centre. Its outline
+	/// follows. Repeated points are skipped and the texture of the
+	/// shape is ignored.
+	///
+	/// \param shape The shape to tessellate
+	/// \param transform Transform to apply to the points of the shape
+	/// \param triangles Vector to which the vertices of the triangles are appended
+	///
+	////////////////////////////////////////////////////////////
+	void triangulate(
+		const sf::Shape& shape,
+		const sf::Transform& transform,
+		std::vector<sf::Vertex>& triangles
+	);
+
 	////////////////////////////////////////////////////////////
 	/// \brief Returns a drawable circle
 	///